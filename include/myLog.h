@@ -0,0 +1 @@
+../src/util/myLog.h
\ No newline at end of file
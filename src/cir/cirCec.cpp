@@ -0,0 +1,257 @@
+/****************************************************************************
+  FileName     [ cirCec.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Combinational equivalence checking of two circuits ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <map>
+#include <climits>
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "sat.h"
+#include "util.h"
+
+using namespace std;
+
+// The miter keeps both circuits side by side over shared PIs: PO 2k is
+// output k of the first circuit, PO 2k+1 the matching output of the
+// second. strash() then merges whatever the two have in common, and
+// fraig() the rest that it can prove; output k is equivalent once both
+// POs are driven by the same literal.
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const size_t CEC_SIM_WORDS = 16;   // x 64 patterns, falsification
+
+// For each name of "b", the position of the same name in "a"; false if a
+// name is missing, repeated or unmatched
+static bool
+matchNames(const vector<string>& a, const vector<string>& b,
+           vector<size_t>& pos)
+{
+  map<string, size_t> index;
+  for (size_t i = 0; i < a.size(); ++i)
+    if (a[i].empty() || !index.insert(make_pair(a[i], i)).second)
+      return false;
+  pos.resize(b.size());
+  for (size_t j = 0; j < b.size(); ++j) {
+    map<string, size_t>::iterator it = index.find(b[j]);
+    if (it == index.end()) return false;
+    pos[j] = it->second;
+    index.erase(it);   // one to one
+  }
+  return true;
+}
+
+static void
+printPattern(const vector<bool>& values)
+{
+  for (size_t i = 0; i < values.size(); ++i)
+    cout << (values[i]? '1' : '0');
+}
+
+/*******************************************************/
+/*   Public member functions about equivalence checking */
+/*******************************************************/
+// Build the miter of "a" and "b" in this (empty) manager. The ports are
+// matched by name if every PI and PO of both circuits has a distinct name
+// and the names agree (unless "byIndex"), by position otherwise. Only the
+// gates in the DFS lists are copied; a floating fanin stays a floating
+// gate of its own side.
+bool
+CirMgr::buildMiter(const CirMgr& a, const CirMgr& b, bool byIndex)
+{
+  size_t nPI = a._piList.size(), nPO = a._poList.size();
+  if (b._piList.size() != nPI || b._poList.size() != nPO) {
+    cerr << "Error: the circuits have different numbers of PIs or POs ("
+         << nPI << "/" << nPO << " vs. " << b._piList.size() << "/"
+         << b._poList.size() << ")!!" << endl;
+    return false;
+  }
+  // position in "a" of each PI/PO of "b"
+  vector<size_t> piPos(nPI), poPos(nPO);
+  bool named = !byIndex;
+  if (named) {
+    vector<string> na(nPI), nb(nPI), oa(nPO), ob(nPO);
+    for (size_t i = 0; i < nPI; ++i) {
+      na[i] = a._piList[i]->_name;
+      nb[i] = b._piList[i]->_name;
+    }
+    for (size_t i = 0; i < nPO; ++i) {
+      oa[i] = a._poList[i]->_name;
+      ob[i] = b._poList[i]->_name;
+    }
+    named = matchNames(na, nb, piPos) && matchNames(oa, ob, poPos);
+  }
+  if (!named)
+    for (size_t i = 0; i < nPI || i < nPO; ++i) {
+      if (i < nPI) piPos[i] = i;
+      if (i < nPO) poPos[i] = i;
+    }
+  cout << "CEC: ports matched by " << (named? "name" : "index") << "."
+       << endl;
+
+  unsigned id = 0, nAig = 0;
+  _gateList.push_back(new ConstGate());
+  for (size_t i = 0; i < nPI; ++i) {
+    CirPiGate* pi = new CirPiGate(++id, a._piList[i]->getLineNo());
+    pi->_name = a._piList[i]->_name;
+    _piList.push_back(pi);
+    _gateList.push_back(pi);
+  }
+  // copy the AND gates of both sides; "drv" are the PO drivers
+  vector<size_t> drv[2];
+  for (size_t s = 0; s < 2; ++s) {
+    const CirMgr& m = s? b : a;
+    vector<CirGate*> copy(m._gateList.size(), (CirGate*)0);
+    copy[0] = _gateList[0];
+    for (size_t i = 0; i < nPI; ++i)
+      copy[m._piList[i]->getId()] = _piList[s? piPos[i] : i];
+    for (size_t i = 0; i < m._dfsList.size(); ++i) {
+      const CirGate* g = m._dfsList[i];
+      if (g->getType() != AIG_GATE) continue;
+      CirGate* ng = copy[g->getId()] = new CirAigGate(++id, g->getLineNo());
+      _gateList.push_back(ng);
+      ++nAig;
+      for (size_t j = 0; j < g->_fanin.size(); ++j) {
+        size_t lit = g->_fanin[j];
+        CirGate*& in = copy[((CirGate*)(lit & ~(size_t)(0x1)))->getId()];
+        if (in == 0) {   // floating
+          in = new CirAigGate(++id, 0);
+          _gateList.push_back(in);
+        }
+        ng->_fanin.push_back((size_t)in | (lit & 1));
+        in->_fanout.push_back((size_t)ng | (lit & 1));
+      }
+    }
+    for (size_t j = 0; j < m._poList.size(); ++j) {
+      size_t lit = m._poList[j]->_fanin[0];
+      CirGate*& in = copy[((CirGate*)(lit & ~(size_t)(0x1)))->getId()];
+      if (in == 0) {
+        in = new CirAigGate(++id, 0);
+        _gateList.push_back(in);
+      }
+      drv[s].push_back((size_t)in | (lit & 1));
+    }
+  }
+  // PO 2k/2k+1: output k of "a" and its match in "b"
+  vector<size_t> poOfB(nPO);
+  for (size_t j = 0; j < nPO; ++j) poOfB[poPos[j]] = j;
+  for (size_t k = 0; k < nPO; ++k)
+    for (size_t s = 0; s < 2; ++s) {
+      size_t j = s? poOfB[k] : k;
+      const CirPoGate* old = (s? b : a)._poList[j];
+      CirPoGate* po = new CirPoGate(id + 1 + _poList.size(),
+                                    old->getLineNo());
+      po->_name = old->_name;
+      size_t lit = drv[s][j];
+      CirGate* in = (CirGate*)(lit & ~(size_t)(0x1));
+      po->_fanin.push_back(lit);
+      in->_fanout.push_back((size_t)po | (lit & 1));
+      _poList.push_back(po);
+      _gateList.push_back(po);
+    }
+  _params[0] = id;
+  _params[1] = nPI;
+  _params[2] = 0;
+  _params[3] = 2 * nPO;
+  _params[4] = nAig;
+  buildDFSList();
+  return true;
+}
+
+// Check every output pair of the miter: random simulation first, then
+// fraig() on what is left, then one SAT call per output not merged by it.
+// Report each output with a counterexample (PI values in the order of the
+// first circuit) where there is one.
+void
+CirMgr::cec()
+{
+  size_t nPO = _poList.size() / 2;
+  vector<int> status(nPO, -1);   // 1/0/-1: different/equivalent/unknown
+  vector<vector<bool> > cex(nPO);
+  size_t nOpen = nPO;
+
+  strash();
+  // falsification by simulation
+  compileSim();
+  for (size_t w = 0; w < CEC_SIM_WORDS && nOpen; ++w) {
+    for (size_t i = 0; i < _piList.size(); ++i)
+      _simSlot[_piList[i]->getId()] =
+        ((size_t)(rnGen(INT_MAX)) << 32) | (size_t)(rnGen(INT_MAX));
+    simulateWord();
+    for (size_t k = 0; k < nPO; ++k) {
+      if (status[k] >= 0) continue;
+      size_t diff = _simSlot[_poList[2*k]->getId()] ^
+                    _simSlot[_poList[2*k+1]->getId()];
+      if (!diff) continue;
+      size_t bit = 0;
+      while (!((diff >> bit) & 1)) ++bit;
+      cex[k].resize(_piList.size());
+      for (size_t i = 0; i < _piList.size(); ++i)
+        cex[k][i] = (_simSlot[_piList[i]->getId()] >> bit) & 1;
+      status[k] = 1;
+      --nOpen;
+    }
+  }
+  _simSlotValid = false;
+
+  // sweeping; fraig() needs the FEC groups of randomSim()
+  if (nOpen) {
+    randomSim();
+    fraig();
+  }
+
+  // one SAT call for each output the sweeping left apart
+  SatSolver solver;
+  solver.initialize();
+  generateProofModel(solver);
+  for (size_t k = 0; k < nPO; ++k) {
+    if (status[k] >= 0) continue;
+    size_t la = _poList[2*k]->_fanin[0], lb = _poList[2*k+1]->_fanin[0];
+    if (la == lb) {
+      status[k] = 0;
+      continue;
+    }
+    CirGate* ga = (CirGate*)(la & ~(size_t)(0x1));
+    CirGate* gb = (CirGate*)(lb & ~(size_t)(0x1));
+    encodeCone(solver, ga);
+    encodeCone(solver, gb);
+    Var act = solver.newVar();
+    solver.addMiterCNF(act, _cnfVar[ga->getId()], la & 1,
+                       _cnfVar[gb->getId()], lb & 1);
+    solver.assumeRelease();
+    solver.assumeProperty(act, true);
+    status[k] = solver.assumpSolveLimited(0, 0);
+    solver.assertProperty(act, false);
+    if (status[k] == 1) {
+      cex[k].resize(_piList.size());
+      for (size_t i = 0; i < _piList.size(); ++i)
+        cex[k][i] = (solver.getValue(_cnfVar[_piList[i]->getId()]) == 1);
+    }
+  }
+
+  size_t n[2] = { 0, 0 };
+  for (size_t k = 0; k < nPO; ++k) {
+    const string& name = _poList[2*k]->_name;
+    cout << "PO " << k;
+    if (!name.empty()) cout << " (" << name << ")";
+    if (status[k] == 0) cout << ": equivalent" << endl;
+    else if (status[k] == 1) {
+      cout << ": NOT equivalent; counterexample ";
+      printPattern(cex[k]);
+      cout << endl;
+    }
+    else cout << ": undecided" << endl;
+    if (status[k] >= 0) ++n[status[k]];
+  }
+  cout << "CEC: " << n[0] << " equivalent, " << n[1] << " not equivalent, "
+       << nPO - n[0] - n[1] << " undecided." << endl;
+  if (n[0] == nPO) cout << "Circuits are equivalent." << endl;
+  else if (n[1]) cout << "Circuits are NOT equivalent." << endl;
+}
@@ -30,7 +30,9 @@ initCirCmd()
          cmdMgr->regCmd("CIRSTRash", 6, new CirStrashCmd) &&
          cmdMgr->regCmd("CIRSIMulate", 6, new CirSimCmd) &&
          cmdMgr->regCmd("CIRFraig", 4, new CirFraigCmd) &&
-         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd)
+         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd) &&
+         cmdMgr->regCmd("CIRCEC", 6, new CirCecCmd) &&
+         cmdMgr->regCmd("CIRLog", 4, new CirLogCmd)
       )) {
       cerr << "Registering \"cir\" commands fails... exiting" << endl;
       return false;
@@ -374,7 +376,7 @@ CirStrashCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRSIMulate <-Random | -File <string patternFile>>
+//    CIRSIMulate <-Random | -File <string patternFile> | -Guided>
 //                [-Output (string logFile)]
 //----------------------------------------------------------------------
 CmdExecStatus
@@ -390,15 +392,34 @@ CirSimCmd::exec(const string& option)
 
    ifstream patternFile;
    ofstream logFile;
-   bool doRandom = false, doFile = false, doLog = false;
+   bool doRandom = false, doFile = false, doGuided = false, doLog = false;
+   bool doSave = false, doLoad = false;
+   int limits[3] = { -1, -1, -1 };  // -Patterns, -Time, -Target
    for (size_t i = 0, n = options.size(); i < n; ++i) {
-      if (myStrNCmp("-Random", options[i], 2) == 0) {
-         if (doRandom || doFile)
+      int* limit = 0;
+      if (myStrNCmp("-Patterns", options[i], 2) == 0) limit = &limits[0];
+      else if (myStrNCmp("-Time", options[i], 3) == 0) limit = &limits[1];
+      else if (myStrNCmp("-Target", options[i], 3) == 0) limit = &limits[2];
+      if (limit) {
+         if (*limit >= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], *limit) || *limit < 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Random", options[i], 2) == 0) {
+         if (doRandom || doFile || doGuided)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          doRandom = true;
       }
+      else if (myStrNCmp("-Guided", options[i], 2) == 0) {
+         if (doRandom || doFile || doGuided)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doGuided = true;
+      }
       else if (myStrNCmp("-File", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doGuided)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
@@ -417,23 +438,49 @@ CirSimCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
          doLog = true;
       }
+      else if (myStrNCmp("-Save", options[i], 2) == 0) {
+         if (doSave)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doSave = true;
+      }
+      else if (myStrNCmp("-Load", options[i], 2) == 0) {
+         if (doLoad)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doLoad = true;
+      }
       else
          return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
 
-   if (!doRandom && !doFile)
+   if (!doRandom && !doFile && !doGuided)
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   // the budgets only apply to random simulation
+   for (size_t i = 0; i < 3; ++i) {
+      if (!doRandom && limits[i] >= 0) {
+         cerr << "Error: budget options need -Random!!" << endl;
+         return CMD_EXEC_ERROR;
+      }
+      if (limits[i] < 0) limits[i] = 0;
+   }
 
    assert (curCmd != CIRINIT);
+   // a saved state only seeds the groups on request; they are then refined
+   if (doLoad && cirMgr->loadSimState(true))
+      cout << "Note: refining the restored FEC groups instead of rebuilding "
+           << "them..." << endl;
    if (doLog)
       cirMgr->setSimLog(&logFile);
    else cirMgr->setSimLog(0);
 
    if (doRandom)
-      cirMgr->randomSim();
+      cirMgr->randomSim(limits[0], limits[1], limits[2]);
+   else if (doGuided)
+      cirMgr->guidedSim();
    else
       cirMgr->fileSim(patternFile);
    cirMgr->setSimLog(0);
+   if (doSave)
+      cirMgr->saveSimState(cirMgr->structHash(), true);
    curCmd = CIRSIMULATE;
    
    return CMD_EXEC_DONE;
@@ -442,8 +489,11 @@ CirSimCmd::exec(const string& option)
 void
 CirSimCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRSIMulate <-Random | -File <string patternFile>>\n"
-      << "                   [-Output (string logFile)]" << endl;
+   os << "Usage: CIRSIMulate <-Random | -File <string patternFile> | -Guided>\n"
+      << "                   [-Output (string logFile)]\n"
+      << "                   [-Patterns <int maxPatterns>] [-TIme <int seconds>]\n"
+      << "                   [-TArget <int candidatePairs>] [-Save] [-Load]"
+      << endl;
 }
 
 void
@@ -467,14 +517,119 @@ CirFraigCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (!options.empty())
-      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+   bool doSave = false, doPipe = false, doStats = false;
+   int nThreads = 0, nBatch = 0, nSeconds = -1;
+   int restart = -1, phase = -1;   // -1: not given
+   string dumpName;
+   bool doDump = false, dumpCsv = false;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Save", options[i], 2) == 0) {
+         if (doSave)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doSave = true;
+      }
+      else if (myStrNCmp("-Pipeline", options[i], 2) == 0) {
+         if (doPipe)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doPipe = true;
+      }
+      else if (myStrNCmp("-THreads", options[i], 3) == 0) {
+         if (nThreads)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], nThreads) || nThreads < 1)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-STats", options[i], 3) == 0) {
+         if (doStats)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doStats = true;
+      }
+      else if (myStrNCmp("-TIme", options[i], 3) == 0) {
+         if (nSeconds >= 0)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], nSeconds) || nSeconds < 1)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Batch", options[i], 2) == 0) {
+         if (nBatch)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], nBatch) || nBatch < 1)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-REstart", options[i], 3) == 0) {
+         if (restart >= 0)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (myStrNCmp("Geometric", options[i], 1) == 0)
+            restart = restart_Geometric;
+         else if (myStrNCmp("Luby", options[i], 1) == 0)
+            restart = restart_Luby;
+         else if (myStrNCmp("GLucose", options[i], 2) == 0)
+            restart = restart_Glucose;
+         else
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-PHase", options[i], 3) == 0) {
+         if (phase >= 0)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (myStrNCmp("Saved", options[i], 1) == 0) phase = 1;
+         else if (myStrNCmp("Negative", options[i], 1) == 0) phase = 0;
+         else
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-DUmp", options[i], 3) == 0) {
+         if (doDump)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (myStrNCmp("Json", options[i], 1) == 0) dumpCsv = false;
+         else if (myStrNCmp("Csv", options[i], 1) == 0) dumpCsv = true;
+         else
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         dumpName = options[i];
+         doDump = true;
+      }
+      else
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
 
-   if (curCmd != CIRSIMULATE) {
+   if (nBatch && (nThreads > 1 || doPipe)) {
+      cerr << "Error: -Batch is for the single-threaded fraig only!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // a saved simulation state stands in for CIRSIMulate; the pipelined
+   // mode simulates by itself
+   if (curCmd != CIRSIMULATE && !cirMgr->loadSimState() && !doPipe) {
       cerr << "Error: circuit is not yet simulated!!" << endl;
       return CMD_EXEC_ERROR;
    }
-   cirMgr->fraig();
+   ofstream dumpFile;
+   if (doDump) {
+      dumpFile.open(dumpName.c_str(), ios::out);
+      if (!dumpFile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, dumpName);
+   }
+   // the patterns found by fraig are saved for the netlist before merging
+   size_t key = cirMgr->structHash();
+   cirMgr->setSatHeuristics(
+      restart >= 0? (RestartPolicy)restart : DEFAULT_SAT_RESTART,
+      phase >= 0? phase == 1 : DEFAULT_SAT_PHASE_SAVING);
+   cirMgr->fraig(nThreads? nThreads : 1, doPipe, nBatch? nBatch : 1,
+                 nSeconds > 0? nSeconds : 0, doStats,
+                 doDump? &dumpFile : 0, dumpCsv);
+   if (doSave)
+      cirMgr->saveSimState(key, false);
    curCmd = CIRFRAIG;
 
    return CMD_EXEC_DONE;
@@ -483,7 +638,12 @@ CirFraigCmd::exec(const string& option)
 void
 CirFraigCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRFraig" << endl;
+   os << "Usage: CIRFraig [-THreads <int nThreads>] [-Pipeline] "
+      << "[-Batch <int pairs>]\n"
+      << "               [-TIme <int seconds>] [-STats] [-Save]\n"
+      << "               [-REstart <Geometric | Luby | GLucose>] "
+      << "[-PHase <Saved | Negative>]\n"
+      << "               [-DUmp <Json | Csv> <(string statsFile)>]" << endl;
 }
 
 void
@@ -565,3 +725,124 @@ CirWriteCmd::help() const
         << "write the netlist to an ASCII AIG file (.aag)\n";
 }
 
+
+//----------------------------------------------------------------------
+//    CIRCEC <(string file1)> <(string file2)> [-Index]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirCecCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   bool byIndex = false;
+   vector<string> files;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Index", options[i], 2) == 0) {
+         if (byIndex)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         byIndex = true;
+      }
+      else if (files.size() == 2)
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+      else files.push_back(options[i]);
+   }
+   if (files.size() < 2)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   // the current circuit, if any, is left alone
+   CirMgr a, b, miter;
+   if (!a.readCircuit(files[0]) || !b.readCircuit(files[1]) ||
+       !miter.buildMiter(a, b, byIndex))
+      return CMD_EXEC_ERROR;
+   miter.cec();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirCecCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRCEC <(string file1)> <(string file2)> [-Index]" << endl;
+}
+
+void
+CirCecCmd::help() const
+{
+   cout << setw(15) << left << "CIRCEC: "
+        << "check two circuits for combinational equivalence\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRLog [-Quiet | -SUmmary | -Verbose]
+//           [-File <string logFile> | -STdout | -None]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirLogCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   int level = -1;
+   enum { SINK_KEEP, SINK_FILE, SINK_STDOUT, SINK_NONE } sink = SINK_KEEP;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      int l = -1;
+      if (myStrNCmp("-Quiet", options[i], 2) == 0) l = LOG_QUIET;
+      else if (myStrNCmp("-SUmmary", options[i], 3) == 0) l = LOG_SUMMARY;
+      else if (myStrNCmp("-Verbose", options[i], 2) == 0) l = LOG_VERBOSE;
+      if (l >= 0) {
+         if (level >= 0)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         level = l;
+         continue;
+      }
+      if (sink != SINK_KEEP &&
+          (myStrNCmp("-File", options[i], 2) == 0 ||
+           myStrNCmp("-STdout", options[i], 3) == 0 ||
+           myStrNCmp("-None", options[i], 2) == 0))
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+      if (myStrNCmp("-File", options[i], 2) == 0) {
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         sink = SINK_FILE;
+         fileName = options[i];
+      }
+      else if (myStrNCmp("-STdout", options[i], 3) == 0) sink = SINK_STDOUT;
+      else if (myStrNCmp("-None", options[i], 2) == 0) sink = SINK_NONE;
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   if (level >= 0) myLog.setLevel((LogLevel)level);
+   if (sink == SINK_FILE && !myLog.toFile(fileName)) {
+      cerr << "Error: cannot open log file \"" << fileName << "\"!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   if (sink == SINK_STDOUT) myLog.toStdout();
+   if (sink == SINK_NONE) myLog.toNowhere();
+   if (options.empty()) {
+      static const char* levelStr[] = { "quiet", "summary", "verbose" };
+      cout << "Log level: " << levelStr[myLog.level()] << ", to "
+           << (myLog.sinkName().empty()? "stdout" : myLog.sinkName()) << endl;
+   }
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirLogCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRLog [-Quiet | -SUmmary | -Verbose]\n"
+      << "              [-File <string logFile> | -STdout | -None]" << endl;
+}
+
+void
+CirLogCmd::help() const
+{
+   cout << setw(15) << left << "CIRLog: "
+        << "set the verbosity and the sink of the pass messages\n";
+}
@@ -20,5 +20,7 @@ CmdClass(CirStrashCmd);
 CmdClass(CirSimCmd);
 CmdClass(CirFraigCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirCecCmd);
+CmdClass(CirLogCmd);
 
 #endif // CIR_CMD_H
@@ -23,10 +23,24 @@ class ConstGate;
 class CirAigGate;
 class CirMgr;
 class SatSolver;
+class FraigJob;
+class FraigPipe;
+class FraigStats;
+struct FraigPair;
 
 typedef vector<CirGate*> GateList;
 typedef vector<size_t> IDList;
 
+// One AND (or PO buffer: _in0 == _in1) of the compiled simulation program.
+// Operands are slots (gate IDs) into CirMgr::_simSlot.
+struct SimInst
+{
+    unsigned _out;
+    unsigned _in0;
+    unsigned _in1;
+    unsigned _op;      // bit 0/1: _in0/_in1 is inverted
+};
+
 enum GateType
 {   
     UNDEF_GATE = 0,
@@ -7,6 +7,11 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <iomanip>
+#include <algorithm>
+#include <deque>
+#include <cmath>
+#include <pthread.h>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "sat.h"
@@ -25,6 +30,359 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// conflict budget of a single check: INIT_CONFLICT_BUDGET in the first
+// round, BUDGET_GROWTH times more in each of the following rounds
+static const int64  INIT_CONFLICT_BUDGET = 1000;
+static const int64  BUDGET_GROWTH        = 8;
+static const size_t MAX_BUDGET_ROUNDS    = 3;
+static const int64  PROPS_PER_CONFLICT   = 1000;  // propagation budget
+static const size_t BATCH_PAIRS          = 32;    // per thread, parallel
+// local check: window of the gates within WINDOW_DEPTH levels of a pair,
+// at most WINDOW_SIZE of them; the fanins at its boundary are left free
+static const size_t WINDOW_DEPTH         = 4;
+static const size_t WINDOW_SIZE          = 48;
+static const int64  WINDOW_CONFLICTS     = 50;
+// CNF preprocessing of the serial solver: once it has PREPROCESS_CLAUSES
+// clauses, then whenever it has PREPROCESS_GROWTH times as many as after the
+// last time
+static const int    PREPROCESS_CLAUSES   = 8192;
+static const int    PREPROCESS_GROWTH    = 2;
+// constant sweeping: a gate harder than this is left to the pairwise checks
+static const int64  CONST_CONFLICTS      = 30;
+static const size_t CONST_MAX_HARD       = 4;     // in a row: stop using SAT
+// pipelined fraig: random words simulated before the threads start, if
+// there are no groups yet
+static const size_t PIPE_WARMUP_WORDS    = 4;
+static const double PIPE_MIN_SPLIT_RATE  = 0.001; // see CirMgr::randomSim()
+// statistics: latency buckets of a decade each from 10us up, the number of
+// slowest pairs kept, and the seconds between progress lines
+static const size_t LATENCY_BUCKETS      = 7;
+static const size_t TOP_SLOW_PAIRS       = 5;
+static const double PROGRESS_SECS        = 5;
+
+// One check, filled in by a worker or by CirMgr::solveBatch()
+struct FraigPair
+{
+  FraigPair(): _gate(0), _rep(0), _inv(false), _budget(0), _result(-1),
+               _local(false) {}
+
+  CirGate*      _gate;
+  CirGate*      _rep;
+  bool          _inv;
+  int64         _budget;  // conflicts
+  int           _result;  // 1/0/-1: SAT/UNSAT/undecided; -2: dropped
+  vector<bool>  _cex;     // PI values, if SAT
+  SatStats      _call;    // of the SAT call that decided it
+  bool          _local;   // proven by CirMgr::localProof()
+};
+
+// The persistent workers of fraigParallel(). The calling thread hands a
+// batch over by setting _busy and advancing _round, then waits for _busy
+// to drop back to 0.
+class FraigPool
+{
+  public:
+    FraigPool(): _round(0), _busy(0), _quit(false) {
+      pthread_mutex_init(&_lock, 0);
+      pthread_cond_init(&_start, 0);
+      pthread_cond_init(&_done, 0);
+    }
+    ~FraigPool() {
+      pthread_mutex_destroy(&_lock);
+      pthread_cond_destroy(&_start);
+      pthread_cond_destroy(&_done);
+    }
+
+    pthread_mutex_t     _lock;     // guards the members below
+    pthread_cond_t      _start;    // _round advanced, or _quit
+    pthread_cond_t      _done;     // _busy is 0
+    size_t              _round;    // batches handed over so far
+    size_t              _busy;     // workers still on the current batch
+    bool                _quit;
+};
+
+// A worker with its own solver. It takes _pairs[k] for k in [_begin, _end)
+// and k = _index (mod _nJobs), so each solver sees the same checks in the
+// same order on every run.
+class FraigJob
+{
+  public:
+    CirMgr*             _mgr;
+    size_t              _index;
+    size_t              _nJobs;
+    vector<FraigPair>*  _pairs;
+    size_t              _begin;
+    size_t              _end;
+    FraigPool*          _pool;     // parallel mode only
+    FraigPipe*          _pipe;     // pipelined mode only
+    size_t              _nProven;  // entries of _pipe->_proven seen so far
+    SatSolver           _solver;
+    vector<Var>         _vars;   // Var of each gate ID in _solver; -1: none
+    vector<Var>         _winVars;  // scratch of localProof()
+};
+
+// Shared state of fraigPipelined(). The coordinator (the calling thread)
+// holds _netlist for writing whenever it touches gates or groups; workers
+// hold it for reading while they look at them.
+class FraigPipe
+{
+  public:
+    FraigPipe(CirMgr* mgr): _mgr(mgr), _done(false), _simDone(false) {
+      pthread_mutex_init(&_lock, 0);
+      pthread_cond_init(&_work, 0);
+      pthread_cond_init(&_news, 0);
+      pthread_rwlock_init(&_netlist, 0);
+    }
+    ~FraigPipe() {
+      pthread_mutex_destroy(&_lock);
+      pthread_cond_destroy(&_work);
+      pthread_cond_destroy(&_news);
+      pthread_rwlock_destroy(&_netlist);
+    }
+
+    CirMgr*             _mgr;
+    pthread_mutex_t     _lock;     // guards the members below
+    pthread_cond_t      _work;     // _todo is not empty, or _done
+    pthread_cond_t      _news;     // _results/_words are not empty, _simDone
+    pthread_rwlock_t    _netlist;
+    deque<FraigPair*>   _todo;
+    vector<FraigPair*>  _results;
+    vector<size_t>      _words;    // PI words that split a group, #PI each
+    vector<FraigPair>   _proven;   // merges so far, for the workers' solvers
+    bool                _done;
+    bool                _simDone;
+    vector<IDList>      _simGroups;  // simulation thread only
+    vector<size_t>      _simSlot;    //   ditto
+};
+
+// Order of the checks in a round: by level of the candidate
+class FraigPairLess
+{
+  public:
+    FraigPairLess(const vector<unsigned>& level): _level(level) {}
+    bool operator () (const FraigPair& a, const FraigPair& b) const {
+      return _level[a._gate->getId()] < _level[b._gate->getId()];
+    }
+    bool operator () (const FraigPair* a, const FraigPair* b) const {
+      return (*this)(*a, *b);
+    }
+  private:
+    const vector<unsigned>& _level;
+};
+
+// Counters of one fraig() run. Only the calling thread updates them; the
+// workers leave the statistics of their calls in FraigPair. The records of
+// the single calls are kept only if "keepCalls" (see dump()).
+class FraigStats
+{
+  public:
+    FraigStats(size_t maxSeconds, bool verbose, bool keepCalls):
+      _nSat(0), _nUnsat(0), _nUndecided(0), _nLocal(0), _nConsts(0),
+      _nMerges(0), _nSimplified(0), _verbose(verbose), _stopped(false),
+      _keepCalls(keepCalls) {
+      for (size_t b = 0; b < LATENCY_BUCKETS; ++b) _hist[b] = 0;
+      _start = _lastProgress = getWallTime();
+      _deadline = maxSeconds? _start + maxSeconds : 0;
+    }
+
+    // Return true once the time budget is used up; print the progress
+    // line every PROGRESS_SECS if verbose
+    bool poll() {
+      if (_stopped) return true;
+      double now = getWallTime();
+      if (_verbose && now - _lastProgress >= PROGRESS_SECS) {
+        size_t n = _nSat + _nUnsat + _nUndecided;
+        cout << "Fraig: " << n << " SAT calls (" << fixed << setprecision(1)
+             << n / (now - _start) << "/s), " << _nMerges << " merges, "
+             << now - _start << " s" << endl;
+        cout.unsetf(ios::floatfield);
+        _lastProgress = now;
+      }
+      return (_stopped = (_deadline && now > _deadline));
+    }
+    // A pass stopped early since poll() found the budget used up
+    bool stopped() const { return _stopped; }
+    // A global SAT call on "nPairs" pairs, the first of them "gate"/"rep"
+    void addCall(int result, const SatStats& s, unsigned gate, unsigned rep,
+                 size_t nPairs) {
+      if (result > 0) ++_nSat;
+      else if (result == 0) ++_nUnsat;
+      else ++_nUndecided;
+      size_t b = 0;
+      for (double lim = 1e-5; b + 1 < LATENCY_BUCKETS && s._time >= lim;
+           lim *= 10)
+        ++b;
+      ++_hist[b];
+      _sat.add(s);
+      if (!_keepCalls) return;
+      CallRecord c = { gate, rep, nPairs, result, s };
+      _calls.push_back(c);
+    }
+    void addCall(const FraigPair& p) {
+      addCall(p._result, p._call, p._gate->getId(), p._rep->getId(), 1);
+    }
+    bool isSlow(double t) const {
+      return _slow.size() < TOP_SLOW_PAIRS || t > _slow.back()._time;
+    }
+    void addSlow(const FraigPair& p, size_t cone) {
+      SlowPair sp = { p._gate->getId(), p._rep->getId(), cone, p._call._time,
+                      p._result };
+      size_t k = _slow.size();
+      while (k && _slow[k-1]._time < sp._time) --k;
+      _slow.insert(_slow.begin() + k, sp);
+      if (_slow.size() > TOP_SLOW_PAIRS) _slow.pop_back();
+    }
+    void report() const;
+    void dump(ostream&, bool csv) const;
+
+    size_t  _nSat, _nUnsat, _nUndecided;   // global SAT calls
+    size_t  _nLocal;                       // pairs proven on a window
+    size_t  _nConsts;                      // gates proven constant
+    size_t  _nMerges, _nSimplified;        // by proof / by propagation
+  private:
+    struct SlowPair {
+      unsigned _gate, _rep;
+      size_t   _cone;   // AND gates in the two fanin cones
+      double   _time;
+      int      _result;
+    };
+    struct CallRecord {
+      unsigned _gate, _rep;
+      size_t   _pairs;
+      int      _result;
+      SatStats _sat;
+    };
+    size_t              _hist[LATENCY_BUCKETS];
+    vector<SlowPair>    _slow;   // slowest first
+    SatStats            _sat;    // of all global SAT calls
+    vector<CallRecord>  _calls;
+    bool                _verbose;
+    bool                _stopped;
+    bool                _keepCalls;
+    double              _start, _lastProgress, _deadline;
+};
+
+void
+FraigStats::report() const
+{
+  double t = getWallTime() - _start;
+  size_t n = _nSat + _nUnsat + _nUndecided;
+  cout << "Fraig Statistics" << endl
+       << "================" << endl
+       << "  SAT calls      " << setw(8) << n << "  (SAT " << _nSat
+       << ", UNSAT " << _nUnsat << ", undecided " << _nUndecided << ")\n"
+       << "  local proofs   " << setw(8) << _nLocal << endl
+       << "  constants      " << setw(8) << _nConsts << endl
+       << "  merges         " << setw(8) << _nMerges << "  (+"
+       << _nSimplified << " simplified)\n" << fixed << setprecision(2)
+       << "  time           " << setw(8) << t << " s";
+  if (t > 0)
+    cout << setprecision(1) << "  (" << n / t << " calls/s, "
+         << _nMerges / t << " merges/s)";
+  cout << endl << "SAT solver" << endl
+       << "  conflicts      " << setw(8) << _sat._conflicts << endl
+       << "  decisions      " << setw(8) << _sat._decisions << endl
+       << "  propagations   " << setw(8) << _sat._propagations << endl
+       << "  restarts       " << setw(8) << _sat._restarts << endl
+       << "  learnt size    " << setw(8) << _sat.learntSize() << endl
+       << "  peak memory    " << setw(8) << _sat._peakMem << " MB" << endl;
+  cout << "Call latency" << endl;
+  const char* bucket[LATENCY_BUCKETS] =
+    { "< 10us", "< 100us", "< 1ms", "< 10ms", "< 100ms", "< 1s", ">= 1s" };
+  for (size_t b = 0; b < LATENCY_BUCKETS; ++b)
+    cout << "  " << left << setw(9) << bucket[b] << right << setw(8)
+         << _hist[b] << endl;
+  if (!_slow.empty())
+    cout << "Slowest pairs" << endl
+         << "      gate       rep    cone    time(s)  result" << endl;
+  for (size_t k = 0; k < _slow.size(); ++k) {
+    const SlowPair& sp = _slow[k];
+    cout << "  " << setw(8) << sp._gate << "  " << setw(8) << sp._rep
+         << "  " << setw(6) << sp._cone << "  " << setprecision(4)
+         << setw(9) << sp._time << "  "
+         << (sp._result > 0? "SAT": (sp._result == 0? "UNSAT": "undecided"))
+         << endl;
+  }
+  cout.unsetf(ios::floatfield);
+  cout << setprecision(6);
+}
+
+// The totals and a record per global SAT call: a JSON object, or CSV with
+// a row per call and a last row of totals
+void
+FraigStats::dump(ostream& os, bool csv) const
+{
+  if (csv) {
+    os << "record,gate,rep,pairs,result,";
+    SatStats::writeCsvHeader(os);
+    os << endl;
+    for (size_t k = 0; k < _calls.size(); ++k) {
+      const CallRecord& c = _calls[k];
+      os << "call," << c._gate << ',' << c._rep << ',' << c._pairs << ','
+         << c._result << ',';
+      c._sat.writeCsv(os);
+      os << endl;
+    }
+    os << "total,,,,,";
+    _sat.writeCsv(os);
+    os << endl;
+    return;
+  }
+  os << "{\n  \"fraig\": {\"sat\": " << _nSat << ", \"unsat\": " << _nUnsat
+     << ", \"undecided\": " << _nUndecided << ", \"local\": " << _nLocal
+     << ", \"consts\": " << _nConsts << ", \"merges\": " << _nMerges
+     << ", \"simplified\": " << _nSimplified << ", \"time\": "
+     << getWallTime() - _start << "},\n  \"totals\": ";
+  _sat.writeJson(os);
+  os << ",\n  \"calls\": [";
+  for (size_t k = 0; k < _calls.size(); ++k) {
+    const CallRecord& c = _calls[k];
+    os << (k? ",\n    " : "\n    ") << "{\"gate\": " << c._gate
+       << ", \"rep\": " << c._rep << ", \"pairs\": " << c._pairs
+       << ", \"result\": " << c._result << ", \"sat\": ";
+    c._sat.writeJson(os);
+    os << "}";
+  }
+  os << (_calls.empty()? "]\n}" : "\n  ]\n}") << endl;
+}
+
+// Run each batch handed over by fraigParallel() until told to quit
+static void*
+fraigWorker(void* arg)
+{
+  FraigJob* job = (FraigJob*)arg;
+  FraigPool& pool = *job->_pool;
+  size_t round = 0;
+  pthread_mutex_lock(&pool._lock);
+  while (true) {
+    while (pool._round == round && !pool._quit)
+      pthread_cond_wait(&pool._start, &pool._lock);
+    if (pool._round == round) break;   // quit
+    round = pool._round;
+    pthread_mutex_unlock(&pool._lock);
+    job->_mgr->runFraigJob(*job);
+    pthread_mutex_lock(&pool._lock);
+    if (--pool._busy == 0) pthread_cond_signal(&pool._done);
+  }
+  pthread_mutex_unlock(&pool._lock);
+  return 0;
+}
+
+static void*
+pipeWorker(void* arg)
+{
+  FraigJob* job = (FraigJob*)arg;
+  job->_mgr->runPipeJob(*job);
+  return 0;
+}
+
+static void*
+pipeSimulator(void* arg)
+{
+  FraigPipe* pipe = (FraigPipe*)arg;
+  pipe->_mgr->runPipeSim(*pipe);
+  return 0;
+}
 
 /*******************************************/
 /*   Public member functions about fraig   */
@@ -53,6 +411,7 @@ class StrashKey
 void
 CirMgr::strash()
 {
+  size_t nMerged = 0;
   HashMap<StrashKey, CirGate*> myMap( (size_t)(_dfsList.size() * 1.6));
   for (size_t i = 0; i < _dfsList.size(); ++i) {
     if (_dfsList[i]->getType() != AIG_GATE) continue;
@@ -80,119 +439,995 @@ CirMgr::strash()
       _gateList[_dfsList[i]->getId()] = NULL;
       delete _dfsList[i];
       --_params[4];
+      ++nMerged;
     }
     else myMap.forceInsert(fanin, _dfsList[i]);
   }
+  if (nMerged && myLog.summary())
+    myLog.out() << "Strashing: " << nMerged << " gates merged.\n";
   buildDFSList();
 }
 
+// Candidates are visited in DFS (topological) order and each is checked
+// only against the representative of its current group (see pickRep()).
+// Counter-examples refine all groups as they come; proven pairs are merged
+// and told to the solver so that later (deeper) checks get easier. Merged
+// gates stay alive (but out of _gateList) until the end, since simulation
+// still walks _dfsList. With "nThreads" > 1, see fraigParallel(); if
+// "pipelined", see fraigPipelined().
+void
+CirMgr::fraig(size_t nThreads, bool pipelined, size_t batch,
+              size_t maxSeconds, bool stats, ostream* dump, bool csv)
+{
+  vector<unsigned> level(_gateList.size(), 0);
+  for (size_t i = 0; i < _dfsList.size(); ++i) {
+    CirGate* g = _dfsList[i];
+    for (size_t j = 0; j < g->_fanin.size(); ++j) {
+      unsigned l = level[((CirGate*)(g->_fanin[j] & ~(size_t)(0x1)))->getId()];
+      if (l + 1 > level[g->getId()]) level[g->getId()] = l + 1;
+    }
+  }
+  GateList merged;
+  FraigStats fs(maxSeconds, stats, dump != 0);
+  _fraigStats = &fs;
+  sweepConsts(level, merged);
+  if (pipelined) fraigPipelined(nThreads, level, merged);
+  else if (nThreads > 1) fraigParallel(nThreads, level, merged);
+  else fraigSerial(level, merged, batch? batch : 1);
+  if (fs.stopped())
+    cout << "Fraig: time budget of " << maxSeconds << " s used up." << endl;
+  if (myLog.summary())
+    myLog.out() << "Fraig: " << fs._nMerges << " gates merged, "
+                << fs._nSimplified << " simplified.\n";
+  if (stats) fs.report();
+  if (dump) fs.dump(*dump, csv);
+  _fraigStats = 0;
+  _patBuf.clear();
+  _nPatBuf = 0;
+  clearFECs();
+  for (size_t i = 0; i < merged.size(); ++i)
+    delete merged[i];
+  buildDFSList();
+  optimize();
+  strash();
+  buildDFSList();
+}
+
+// Constant sweeping, ahead of the pairwise checks: a gate in the group of
+// CONST0 is proven constant by assuming the other value alone, on one
+// solver for all of them. The constants are then propagated through their
+// fanouts like optimize() does, except that the gates are only unlinked.
+void
+CirMgr::sweepConsts(const vector<unsigned>& level, GateList& merged)
+{
+  IDList* grp = _gateList[0]->_fecs;
+  if (grp == NULL || grp->size() < 2) return;
+  size_t lit0 = 0;
+  while ((*grp)[lit0]/2 != 0) ++lit0;
+  lit0 = (*grp)[lit0];
+  vector<FraigPair> cands;
+  for (size_t j = 0; j < grp->size(); ++j) {
+    CirGate* g = getGate((*grp)[j]/2);
+    if (g == NULL || g->getType() != AIG_GATE) continue;
+    cands.push_back(FraigPair());
+    cands.back()._gate = g;
+    cands.back()._rep = _gateList[0];
+    cands.back()._inv = ((*grp)[j] ^ lit0) & 1;
+  }
+  sort(cands.begin(), cands.end(), FraigPairLess(level));
+
+  SatSolver solver;
+  initSolver(solver);
+  generateProofModel(solver);
+  vector<Var> winVars(_gateList.size(), -1);
+  size_t nConsts = 0, nHard = 0;
+  for (size_t k = 0; k < cands.size() && !_fraigStats->poll(); ++k) {
+    FraigPair& p = cands[k];
+    // split off by a counterexample? (the groups are rebuilt on a flush)
+    if (p._gate->_fecs == NULL || p._gate->_fecs != _gateList[0]->_fecs)
+      continue;
+    if (localProof(_gateList[0], p._gate, p._inv, winVars)) {
+      if (_cnfVar[p._gate->getId()] >= 0)
+        solver.assertProperty(_cnfVar[p._gate->getId()], p._inv);
+      fraigMerge(p._gate, _gateList[0], p._inv, merged);
+      ++nConsts;
+      ++_fraigStats->_nLocal;
+      continue;
+    }
+    if (nHard == CONST_MAX_HARD) continue;
+    encodeCone(solver, p._gate);
+    solver.assumeRelease();
+    solver.assumeProperty(_cnfVar[p._gate->getId()], !p._inv);
+    p._result = solver.assumpSolveLimited(CONST_CONFLICTS,
+                                          CONST_CONFLICTS * PROPS_PER_CONFLICT);
+    p._call = solver.getLastCall();
+    _fraigStats->addCall(p);
+    recordPair(p);
+    int result = p._result;
+    if (result < 0) {   // left to the pairwise checks
+      ++nHard;
+      continue;
+    }
+    nHard = 0;
+    if (result) {
+      recordPattern(solver);
+      if (_nPatBuf == 64) flushPatterns();
+      continue;
+    }
+    solver.assertProperty(_cnfVar[p._gate->getId()], p._inv);
+    fraigMerge(p._gate, _gateList[0], p._inv, merged);
+    ++nConsts;
+  }
+  flushPatterns();
+  _fraigStats->_nConsts = nConsts;
+  if (nConsts == 0) return;
+
+  // gates fed by the constants may now be trivial
+  for (size_t i = 0; i < _dfsList.size(); ++i) {
+    CirGate* g = _dfsList[i];
+    if (g->getType() != AIG_GATE || _gateList[g->getId()] != g) continue;
+    CirGate* to;
+    size_t inv;
+    if (simplifyTarget(g, to, inv)) fraigMerge(g, to, inv, merged, false);
+  }
+}
+
 void
-CirMgr::fraig()
+CirMgr::fraigSerial(const vector<unsigned>& level, GateList& merged,
+                    size_t batchSize)
 {
   // initialize circuit
   SatSolver solver;
-  solver.initialize();
-  // generate proof model
-  Var v1 = solver.newVar();
-  Var v2 = solver.newVar();
-  solver.addAigCNF(v1, v2, false, v2, true);
+  initSolver(solver);
   generateProofModel(solver);
   // proofing
-  bool result;
-  for (size_t i = 0; i < _fecList.size(); ++i) {
-    IDList& fecs = _fecList[i];
-    for (size_t j = 0; j < fecs.size(); ++j) {
-      for (size_t k = j+1; k < fecs.size(); ++k) {
-        Var newVar = solver.newVar();
-        CirGate* ptr[2];
-        if (getGate(fecs[j]/2) == NULL) continue;
-        if (getGate(fecs[k]/2) == NULL) continue;
-        ptr[0] = getGate(fecs[j]/2);
-        ptr[1] = getGate(fecs[k]/2);
-        bool flag[2];
-        flag[0] = (fecs[j]%2 == 1);
-        flag[1] = (fecs[k]%2 == 1);
-        solver.addXorCNF(newVar, ptr[0]->_var, flag[0], ptr[1]->_var, flag[1]);
-        solver.assumeRelease();
-        solver.assumeProperty(newVar, true);
-        result = solver.assumpSolve();
-        if (!result) {
-          CirGate* in[2];
-          in[0] = (CirGate*)(ptr[1]->_fanin[0] & ~(size_t)(0x1));
-          in[1] = (CirGate*)(ptr[1]->_fanin[1] & ~(size_t)(0x1));
-          --_params[4];
-
-          merge(ptr[1], ptr[0], (size_t)flag[0]^flag[1], "Fraig: ");
-          // remove some NULL fanouts
-          for (size_t m = 0; m < 2; ++m) {
-            for (size_t n = 0; n < in[m]->_fanout.size(); ++n) {
-              if ( (CirGate*)(in[m]->_fanout[n] & ~(size_t)(0x1)) == ptr[1])
-                in[m]->_fanout.erase(in[m]->_fanout.begin()+n);
-            }
-            if (in[m]->getType() == UNDEF_GATE && in[m]->_fanout.size() == 0) {
-              _gateList[in[m]->getId()] = NULL;
-              delete in[m];
+  GateList cands;
+  for (size_t i = 0; i < _dfsList.size(); ++i)
+    if (_dfsList[i]->_fecs) cands.push_back(_dfsList[i]);
+  GateList retry;   // SAT against a rep; new group pending
+  // rep each gate was last found different from; a floating fanin is free
+  // in the CNF but 0 in simulation, so a model need not split the group
+  vector<unsigned> satRep(_gateList.size(), 0);
+  // pairs that run out of budget wait until everything easier is merged,
+  // then get a larger budget
+  GateList hard;
+  int64 budget = INIT_CONFLICT_BUDGET;
+  vector<FraigPair> batch;
+  vector<Var> winVars(_gateList.size(), -1);
+  int nextPreprocess = PREPROCESS_CLAUSES;
+  bool stopped = false;   // time budget used up
+  for (size_t round = 0; ; ++round) {
+    size_t i = 0;
+    do {
+      while (i < cands.size() && !(stopped = _fraigStats->poll())) {
+        // take up to "batchSize" checks; they are all picked before any of
+        // them is solved
+        for (; i < cands.size() && batch.size() < batchSize; ++i) {
+          CirGate* g = cands[i];
+          IDList* grp = g->_fecs;
+          if (grp == NULL) continue;
+          // pick the representative; done anew since the group may have split
+          size_t r = pickRep(*grp, level), self = 0;
+          while (getGate((*grp)[self]/2) != g) ++self;
+          if (r == self) continue;
+          CirGate* rep = getGate((*grp)[r]/2);
+          if (satRep[g->getId()] == rep->getId() + 1) continue;
+          bool inv = ((*grp)[r] ^ (*grp)[self]) & 1;
+          if (localProof(rep, g, inv, winVars)) {
+            ++_fraigStats->_nLocal;
+            // the global solver learns it only if it knows both gates
+            if (_cnfVar[rep->getId()] >= 0 && _cnfVar[g->getId()] >= 0)
+              solver.addEqCNF(_cnfVar[rep->getId()], false,
+                              _cnfVar[g->getId()], inv);
+            fraigMerge(g, rep, inv, merged);
+            continue;
+          }
+          encodeCone(solver, rep);
+          encodeCone(solver, g);
+          batch.push_back(FraigPair());
+          FraigPair& p = batch.back();
+          p._gate = g;
+          p._rep = rep;
+          p._inv = inv;
+          p._budget = budget;
+        }
+        if (batch.empty()) break;
+        if (solver.nClauses() >= nextPreprocess) {
+          preprocessCNF(solver);
+          nextPreprocess = PREPROCESS_GROWTH * solver.nClauses();
+          if (nextPreprocess < PREPROCESS_CLAUSES)
+            nextPreprocess = PREPROCESS_CLAUSES;
+        }
+        solveBatch(solver, batch);
+        for (size_t k = 0; k < batch.size(); ++k) {
+          FraigPair& p = batch[k];
+          recordPair(p);
+          if (p._result < 0) {   // too hard for now
+            hard.push_back(p._gate);
+            continue;
+          }
+          if (p._result) {
+            if (!p._cex.empty()) recordPattern(p._cex);
+            satRep[p._gate->getId()] = p._rep->getId() + 1;
+            retry.push_back(p._gate);
+            // once the patterns are simulated, the gate may find a new
+            // representative
+            if (_nPatBuf == 64) {
+              flushPatterns();
+              cands.insert(cands.end(), retry.begin(), retry.end());
+              retry.clear();
             }
+            continue;
           }
-          ////////////////////////////////////////////////////////////
-          _gateList[ptr[1]->getId()] = NULL;
-          delete ptr[1];
-          fecs.erase(fecs.begin()+k);
-          --k;
-          cout << "Updating by UNSAT... Total #FEC Group = " << _fecList.size() << endl;
-          
+          solver.addEqCNF(_cnfVar[p._rep->getId()], false,
+                          _cnfVar[p._gate->getId()], p._inv);
+          fraigMerge(p._gate, p._rep, p._inv, merged);
         }
+        batch.clear();
       }
+      // simulate what is left in the buffer and revisit
+      flushPatterns();
+      cands.insert(cands.end(), retry.begin(), retry.end());
+      retry.clear();
+    } while (i < cands.size() && !stopped);
+    if (stopped || hard.empty() || round + 1 == MAX_BUDGET_ROUNDS) break;
+    cands.swap(hard);
+    hard.clear();
+    budget *= BUDGET_GROWTH;
+  }
+  if (!hard.empty() && !stopped)
+    cout << "Fraig: " << hard.size() << " pairs left undecided." << endl;
+}
+
+// Each round collects one check per non-representative member of every
+// group, lets the workers prove them, then applies the results in the
+// order the checks were collected, so that a run with the same "nThreads"
+// always ends up with the same netlist. Workers only read the netlist;
+// merges and simulation happen between rounds. The worker threads are
+// started once; each batch is handed to them through a FraigPool.
+void
+CirMgr::fraigParallel(size_t nThreads, const vector<unsigned>& level,
+                      GateList& merged)
+{
+  vector<FraigPair> pairs;
+  vector<FraigJob*> jobs(nThreads);
+  FraigPool pool;
+  for (size_t k = 0; k < nThreads; ++k) {
+    FraigJob* job = jobs[k] = new FraigJob;
+    job->_mgr = this;
+    job->_index = k;
+    job->_nJobs = nThreads;
+    job->_pairs = &pairs;
+    job->_pool = &pool;
+    job->_pipe = 0;
+    initSolver(job->_solver);
+    job->_vars.assign(_gateList.size(), -1);
+    job->_vars[0] = job->_solver.newVar();
+    job->_solver.assertProperty(job->_vars[0], false);
+  }
+  // see fraigSerial(); "tries" counts the budgets a gate has run out of
+  vector<unsigned> satRep(_gateList.size(), 0), tries(_gateList.size(), 0);
+  size_t nUndecided = 0;
+  bool stopped = false;   // time budget used up
+  // a job whose thread cannot be started is run by the calling thread
+  vector<pthread_t> threads(nThreads);
+  vector<bool> started(nThreads, false);
+  size_t nStarted = 0;
+  for (size_t k = 0; k < nThreads; ++k) {
+    if (pthread_create(&threads[k], 0, fraigWorker, jobs[k]) != 0)
+      cerr << "Error: cannot start fraig thread " << k << "!!" << endl;
+    else {
+      started[k] = true;
+      ++nStarted;
     }
   }
-  _fecList.clear();
-  clearFECs();
-  buildDFSList();
-  optimize();
-  strash();
-  buildDFSList();
+  while (true) {
+    pairs.clear();
+    for (size_t i = 0; i < _fecList.size(); ++i) {
+      const IDList& grp = _fecList[i];
+      size_t r = pickRep(grp, level);
+      CirGate* rep = getGate(grp[r]/2);
+      for (size_t j = 0; j < grp.size(); ++j) {
+        CirGate* g = getGate(grp[j]/2);
+        if (j == r || satRep[g->getId()] == rep->getId() + 1 ||
+            tries[g->getId()] == MAX_BUDGET_ROUNDS) continue;
+        FraigPair p;
+        p._gate = g;
+        p._rep = rep;
+        p._inv = (grp[r] ^ grp[j]) & 1;
+        p._budget = INIT_CONFLICT_BUDGET;
+        for (size_t t = 0; t < tries[g->getId()]; ++t)
+          p._budget *= BUDGET_GROWTH;
+        p._result = -1;
+        pairs.push_back(p);
+      }
+    }
+    if (pairs.empty()) break;
+    // lower pairs first, in batches, so that their merges help the others
+    stable_sort(pairs.begin(), pairs.end(), FraigPairLess(level));
+    for (size_t b = 0; b < pairs.size() && !(stopped = _fraigStats->poll());
+         b += BATCH_PAIRS * nThreads) {
+      size_t e = b + BATCH_PAIRS * nThreads;
+      if (e > pairs.size()) e = pairs.size();
+      // counter-examples of the last batch may have split the pair
+      for (size_t k = b; k < e; ++k)
+        if (pairs[k]._gate->_fecs == NULL ||
+            pairs[k]._gate->_fecs != pairs[k]._rep->_fecs)
+          pairs[k]._result = -2;
+      for (size_t k = 0; k < nThreads; ++k) {
+        jobs[k]->_begin = b;
+        jobs[k]->_end = e;
+      }
+      pthread_mutex_lock(&pool._lock);
+      pool._busy = nStarted;
+      ++pool._round;
+      pthread_cond_broadcast(&pool._start);
+      pthread_mutex_unlock(&pool._lock);
+      for (size_t k = 0; k < nThreads; ++k)
+        if (!started[k]) runFraigJob(*jobs[k]);
+      pthread_mutex_lock(&pool._lock);
+      while (pool._busy)
+        pthread_cond_wait(&pool._done, &pool._lock);
+      pthread_mutex_unlock(&pool._lock);
+      for (size_t k = b; k < e; ++k) {
+        FraigPair& p = pairs[k];
+        if (p._local) ++_fraigStats->_nLocal;
+        else if (p._result != -2) {
+          _fraigStats->addCall(p);
+          recordPair(p);
+        }
+        if (p._result == 0) {
+          for (size_t j = 0; j < nThreads; ++j) {
+            const vector<Var>& v = jobs[j]->_vars;
+            if (v[p._rep->getId()] >= 0 && v[p._gate->getId()] >= 0)
+              jobs[j]->_solver.addEqCNF(v[p._rep->getId()], false,
+                                        v[p._gate->getId()], p._inv);
+          }
+          fraigMerge(p._gate, p._rep, p._inv, merged);
+        }
+        else if (p._result == 1) {
+          satRep[p._gate->getId()] = p._rep->getId() + 1;
+          recordPattern(p._cex);
+          if (_nPatBuf == 64) flushPatterns();
+        }
+        else if (p._result == -1 &&
+                 ++tries[p._gate->getId()] == MAX_BUDGET_ROUNDS)
+          ++nUndecided;
+      }
+    }
+    flushPatterns();
+    if (stopped) break;
+  }
+  pthread_mutex_lock(&pool._lock);
+  pool._quit = true;
+  pthread_cond_broadcast(&pool._start);
+  pthread_mutex_unlock(&pool._lock);
+  for (size_t k = 0; k < nThreads; ++k)
+    if (started[k]) pthread_join(threads[k], 0);
+  for (size_t k = 0; k < nThreads; ++k)
+    delete jobs[k];
+  if (nUndecided && !stopped)
+    cout << "Fraig: " << nUndecided << " pairs left undecided." << endl;
+}
+
+// Simulation and SAT overlap: a simulation thread keeps refining its own
+// copy of the groups with random words and hands over those that split
+// something; "nThreads" workers take checks from a queue and drop those
+// whose pair has been split in the meantime. The calling thread applies
+// words, counter-examples and merges, and queues new checks. Unlike
+// fraigParallel(), the result depends on timing.
+void
+CirMgr::fraigPipelined(size_t nThreads, const vector<unsigned>& level,
+                       GateList& merged)
+{
+  compileSim();
+  if (_fecList.empty()) {
+    initFECs();
+    for (size_t r = 0; r < PIPE_WARMUP_WORDS; ++r) {
+      for (size_t i = 0; i < _piList.size(); ++i)
+        _simSlot[_piList[i]->getId()] =
+          ((size_t)(rnGen(INT_MAX)) << 32) | (size_t)(rnGen(INT_MAX));
+      simulateWord();
+      collectValidFECs();
+    }
+  }
+  FraigPipe pipe(this);
+  pipe._simGroups = _fecList;
+  pipe._simSlot = _simSlot;
+  vector<FraigJob*> jobs(nThreads);
+  vector<pthread_t> threads(nThreads);
+  pthread_t simThread;
+  for (size_t k = 0; k < nThreads; ++k) {
+    FraigJob* job = jobs[k] = new FraigJob;
+    job->_mgr = this;
+    job->_index = k;
+    job->_nJobs = nThreads;
+    job->_pairs = 0;
+    job->_pool = 0;
+    job->_pipe = &pipe;
+    job->_nProven = 0;
+    initSolver(job->_solver);
+    job->_vars.assign(_gateList.size(), -1);
+    job->_vars[0] = job->_solver.newVar();
+    job->_solver.assertProperty(job->_vars[0], false);
+  }
+  size_t nStarted = 0;
+  bool simStarted =
+    (pthread_create(&simThread, 0, pipeSimulator, &pipe) == 0);
+  while (simStarted && nStarted < nThreads &&
+         pthread_create(&threads[nStarted], 0, pipeWorker, jobs[nStarted]) == 0)
+    ++nStarted;
+  if (nStarted < nThreads) {
+    cerr << "Error: cannot start fraig threads!!" << endl;
+    pthread_mutex_lock(&pipe._lock);
+    pipe._done = true;
+    pthread_cond_broadcast(&pipe._work);
+    pthread_mutex_unlock(&pipe._lock);
+    for (size_t k = 0; k < nStarted; ++k) pthread_join(threads[k], 0);
+    if (simStarted) pthread_join(simThread, 0);
+    for (size_t k = 0; k < nThreads; ++k) delete jobs[k];
+    fraigSerial(level, merged, 1);
+    return;
+  }
+  // see fraigParallel()
+  vector<unsigned> satRep(_gateList.size(), 0), tries(_gateList.size(), 0);
+  vector<bool> queued(_gateList.size(), false);
+  size_t nUndecided = 0, outstanding = 0;
+  vector<FraigPair*> results, fresh;
+  vector<FraigPair> proven;
+  vector<size_t> words;
+  bool stopped = false;   // time budget used up
+  pthread_rwlock_wrlock(&pipe._netlist);
+  while (true) {
+    // queue a check for every member that has none
+    if (outstanding == 0) flushPatterns();
+    for (size_t i = 0; i < _fecList.size() && !stopped; ++i) {
+      const IDList& grp = _fecList[i];
+      size_t r = pickRep(grp, level);
+      CirGate* rep = getGate(grp[r]/2);
+      for (size_t j = 0; j < grp.size(); ++j) {
+        CirGate* g = getGate(grp[j]/2);
+        if (j == r || queued[g->getId()] ||
+            satRep[g->getId()] == rep->getId() + 1 ||
+            tries[g->getId()] == MAX_BUDGET_ROUNDS) continue;
+        // only a check left out counts as stopping early
+        if ((stopped = _fraigStats->poll())) break;
+        FraigPair* p = new FraigPair;
+        p->_gate = g;
+        p->_rep = rep;
+        p->_inv = (grp[r] ^ grp[j]) & 1;
+        p->_budget = INIT_CONFLICT_BUDGET;
+        for (size_t t = 0; t < tries[g->getId()]; ++t)
+          p->_budget *= BUDGET_GROWTH;
+        p->_result = -1;
+        queued[g->getId()] = true;
+        fresh.push_back(p);
+      }
+    }
+    stable_sort(fresh.begin(), fresh.end(), FraigPairLess(level));
+    pthread_rwlock_unlock(&pipe._netlist);
+
+    pthread_mutex_lock(&pipe._lock);
+    if (stopped && !pipe._done) {
+      // drop the checks not started yet; the rest finish as usual
+      outstanding -= pipe._todo.size();
+      for (size_t k = 0; k < pipe._todo.size(); ++k) delete pipe._todo[k];
+      pipe._todo.clear();
+      pipe._done = true;
+      pthread_cond_broadcast(&pipe._work);
+    }
+    pipe._todo.insert(pipe._todo.end(), fresh.begin(), fresh.end());
+    pipe._proven.insert(pipe._proven.end(), proven.begin(), proven.end());
+    outstanding += fresh.size();
+    if (!fresh.empty()) pthread_cond_broadcast(&pipe._work);
+    fresh.clear();
+    proven.clear();
+    while (pipe._results.empty() && pipe._words.empty() &&
+           !(outstanding == 0 && pipe._simDone))
+      pthread_cond_wait(&pipe._news, &pipe._lock);
+    if (outstanding == 0 && pipe._simDone && pipe._words.empty() &&
+        pipe._results.empty() && _nPatBuf == 0) {
+      pipe._done = true;
+      pthread_cond_broadcast(&pipe._work);
+      pthread_mutex_unlock(&pipe._lock);
+      break;
+    }
+    results.swap(pipe._results);
+    words.swap(pipe._words);
+    pthread_mutex_unlock(&pipe._lock);
+
+    pthread_rwlock_wrlock(&pipe._netlist);
+    for (size_t w = 0; w < words.size(); w += _piList.size()) {
+      for (size_t i = 0; i < _piList.size(); ++i)
+        _simSlot[_piList[i]->getId()] = words[w + i];
+      simulateWord();
+      storeSimWord();
+      collectValidFECs();
+    }
+    words.clear();
+    for (size_t k = 0; k < results.size(); ++k) {
+      FraigPair* p = results[k];
+      queued[p->_gate->getId()] = false;
+      --outstanding;
+      if (p->_local) ++_fraigStats->_nLocal;
+      else if (p->_result != -2) {
+        _fraigStats->addCall(*p);
+        recordPair(*p);
+      }
+      if (p->_result == 0) {
+        proven.push_back(*p);
+        fraigMerge(p->_gate, p->_rep, p->_inv, merged);
+      }
+      else if (p->_result == 1) {
+        satRep[p->_gate->getId()] = p->_rep->getId() + 1;
+        recordPattern(p->_cex);
+        if (_nPatBuf == 64) flushPatterns();
+      }
+      else if (p->_result == -1 &&
+               ++tries[p->_gate->getId()] == MAX_BUDGET_ROUNDS)
+        ++nUndecided;
+      delete p;
+    }
+    results.clear();
+  }
+  for (size_t k = 0; k < nThreads; ++k)
+    pthread_join(threads[k], 0);
+  pthread_join(simThread, 0);
+  for (size_t k = 0; k < nThreads; ++k)
+    delete jobs[k];
+  if (nUndecided && !stopped)
+    cout << "Fraig: " << nUndecided << " pairs left undecided." << endl;
 }
 
 /********************************************/
 /*   Private member functions about fraig   */
 /********************************************/
 
+// Body of a fraigParallel() worker thread
+void
+CirMgr::runFraigJob(FraigJob& job)
+{
+  vector<FraigPair>& pairs = *job._pairs;
+  size_t k = job._begin + (job._index + job._nJobs - job._begin % job._nJobs)
+                         % job._nJobs;
+  for (; k < job._end; k += job._nJobs) {
+    FraigPair& p = pairs[k];
+    if (p._result == -2) continue;   // dropped before the batch started
+    if ((p._local = localProof(p._rep, p._gate, p._inv, job._winVars)))
+      p._result = 0;
+    else solvePair(job, p);
+  }
+}
+
+// Body of a fraigPipelined() worker thread
+void
+CirMgr::runPipeJob(FraigJob& job)
+{
+  FraigPipe& pipe = *job._pipe;
+  vector<FraigPair> proven;
+  while (true) {
+    pthread_mutex_lock(&pipe._lock);
+    while (pipe._todo.empty() && !pipe._done)
+      pthread_cond_wait(&pipe._work, &pipe._lock);
+    if (pipe._todo.empty()) {
+      pthread_mutex_unlock(&pipe._lock);
+      return;
+    }
+    FraigPair* p = pipe._todo.front();
+    pipe._todo.pop_front();
+    proven.assign(pipe._proven.begin() + job._nProven, pipe._proven.end());
+    job._nProven = pipe._proven.size();
+    pthread_mutex_unlock(&pipe._lock);
+
+    for (size_t k = 0; k < proven.size(); ++k) {
+      Var a = job._vars[proven[k]._rep->getId()];
+      Var b = job._vars[proven[k]._gate->getId()];
+      if (a >= 0 && b >= 0) job._solver.addEqCNF(a, false, b, proven[k]._inv);
+    }
+    pthread_rwlock_rdlock(&pipe._netlist);
+    bool stale = (p->_gate->_fecs == NULL ||
+                  p->_gate->_fecs != p->_rep->_fecs);
+    bool local = !stale &&
+                 localProof(p->_rep, p->_gate, p->_inv, job._winVars);
+    if (!stale && !local) {
+      encodeCone(job._solver, p->_rep, job._vars);
+      encodeCone(job._solver, p->_gate, job._vars);
+    }
+    pthread_rwlock_unlock(&pipe._netlist);
+    if (stale) p->_result = -2;
+    else if (local) {
+      p->_result = 0;
+      p->_local = true;
+    }
+    else solvePair(job, *p);   // cones are encoded; no netlist access
+
+    pthread_mutex_lock(&pipe._lock);
+    pipe._results.push_back(p);
+    pthread_cond_signal(&pipe._news);
+    pthread_mutex_unlock(&pipe._lock);
+  }
+}
+
+// Body of the fraigPipelined() simulation thread; stops like randomSim()
+void
+CirMgr::runPipeSim(FraigPipe& pipe)
+{
+  size_t window = 4 + log2(_dfsList.size()), nPairs = 0, recent = 0;
+  for (size_t i = 0; i < pipe._simGroups.size(); ++i)
+    nPairs += pipe._simGroups[i].size() - 1;
+  vector<size_t> splits(window, 0);
+  size_t* v = &pipe._simSlot[0];
+  for (size_t r = 0; nPairs; ++r) {
+    pthread_mutex_lock(&pipe._lock);
+    bool done = pipe._done;
+    pthread_mutex_unlock(&pipe._lock);
+    if (done) break;
+    for (size_t i = 0; i < _piList.size(); ++i)
+      v[_piList[i]->getId()] =
+        ((size_t)(rnGen(INT_MAX)) << 32) | (size_t)(rnGen(INT_MAX));
+    simulateWord(v);
+    size_t left = splitGroups(pipe._simGroups, v);
+    if (left < nPairs) {
+      pthread_mutex_lock(&pipe._lock);
+      for (size_t i = 0; i < _piList.size(); ++i)
+        pipe._words.push_back(v[_piList[i]->getId()]);
+      pthread_cond_signal(&pipe._news);
+      pthread_mutex_unlock(&pipe._lock);
+    }
+    recent += (nPairs - left) - splits[r % window];
+    splits[r % window] = nPairs - left;
+    nPairs = left;
+    if (r + 1 >= window && recent <= nPairs * PIPE_MIN_SPLIT_RATE) break;
+  }
+  pthread_mutex_lock(&pipe._lock);
+  pipe._simDone = true;
+  pthread_cond_signal(&pipe._news);
+  pthread_mutex_unlock(&pipe._lock);
+}
+
+// Check one pair in the solver of "job"; fills in _result and _cex
+void
+CirMgr::solvePair(FraigJob& job, FraigPair& p) const
+{
+  SatSolver& solver = job._solver;
+  encodeCone(solver, p._rep, job._vars);
+  encodeCone(solver, p._gate, job._vars);
+  Var act = solver.newVar();
+  solver.addMiterCNF(act, job._vars[p._rep->getId()], false,
+                     job._vars[p._gate->getId()], p._inv);
+  solver.assumeRelease();
+  solver.assumeProperty(act, true);
+  p._result = solver.assumpSolveLimited(p._budget,
+                                        p._budget * PROPS_PER_CONFLICT);
+  p._call = solver.getLastCall();
+  solver.assertProperty(act, false);
+  if (p._result != 1) return;
+  // PIs outside both cones are free; take 0
+  p._cex.assign(_piList.size(), false);
+  for (size_t i = 0; i < _piList.size(); ++i) {
+    Var v = job._vars[_piList[i]->getId()];
+    p._cex[i] = (v >= 0 && solver.getValue(v) == 1);
+  }
+}
+
+// Try to prove "a" == "b" (inverted if "inv") on a small window around
+// them: the AND gates within WINDOW_DEPTH levels of either, WINDOW_SIZE at
+// most, with every fanin at its boundary a free variable. As the boundary
+// may take values it cannot take in the circuit, only UNSAT is conclusive.
+// "vars" is scratch, indexed by gate ID; it is left all -1.
+bool
+CirMgr::localProof(CirGate* a, CirGate* b, bool inv, vector<Var>& vars) const
+{
+  if (vars.size() != _gateList.size()) vars.assign(_gateList.size(), -1);
+  // breadth-first; vars is -2 for the gates seen
+  GateList win;
+  vector<size_t> depth;
+  win.push_back(a);  depth.push_back(0);  vars[a->getId()] = -2;
+  win.push_back(b);  depth.push_back(0);  vars[b->getId()] = -2;
+  vector<bool> inside(2, false);
+  for (size_t k = 0; k < win.size(); ++k) {
+    CirGate* g = win[k];
+    if (g->getType() != AIG_GATE || depth[k] == WINDOW_DEPTH ||
+        win.size() + 2 > WINDOW_SIZE) continue;
+    inside[k] = true;
+    for (size_t j = 0; j < g->_fanin.size(); ++j) {
+      CirGate* in = (CirGate*)(g->_fanin[j] & ~(size_t)(0x1));
+      if (vars[in->getId()] == -2) continue;
+      vars[in->getId()] = -2;
+      win.push_back(in);
+      depth.push_back(depth[k] + 1);
+      inside.push_back(false);
+    }
+  }
+  bool proven = false;
+  if (inside[0] || inside[1]) {
+    SatSolver solver;
+    initSolver(solver);
+    for (size_t k = 0; k < win.size(); ++k) {
+      if (inside[k]) { vars[win[k]->getId()] = -1; continue; }
+      Var v = vars[win[k]->getId()] = solver.newVar();
+      if (win[k]->getType() == CONST_GATE) solver.assertProperty(v, false);
+    }
+    encodeCone(solver, a, vars);
+    encodeCone(solver, b, vars);
+    Var act = solver.newVar();
+    solver.addMiterCNF(act, vars[a->getId()], false, vars[b->getId()], inv);
+    solver.assumeProperty(act, true);
+    proven = (solver.assumpSolveLimited(WINDOW_CONFLICTS,
+                                        WINDOW_CONFLICTS * PROPS_PER_CONFLICT)
+              == 0);
+  }
+  for (size_t k = 0; k < win.size(); ++k)
+    vars[win[k]->getId()] = -1;
+  return proven;
+}
+
+// Keep "p" in the statistics if it is among the slowest pairs so far;
+// call before the pair is merged
+void
+CirMgr::recordPair(const FraigPair& p) const
+{
+  if (_fraigStats->isSlow(p._call._time))
+    _fraigStats->addSlow(p, coneSize(p._gate, p._rep));
+}
+
+// Number of AND gates in the union of the fanin cones of "a" and "b"
+size_t
+CirMgr::coneSize(const CirGate* a, const CirGate* b) const
+{
+  vector<bool> seen(_gateList.size(), false);
+  vector<const CirGate*> stack;
+  stack.push_back(a);
+  stack.push_back(b);
+  size_t n = 0;
+  while (!stack.empty()) {
+    const CirGate* g = stack.back();
+    stack.pop_back();
+    if (seen[g->getId()]) continue;
+    seen[g->getId()] = true;
+    if (g->getType() == AIG_GATE) ++n;
+    for (size_t j = 0; j < g->_fanin.size(); ++j)
+      stack.push_back((const CirGate*)(g->_fanin[j] & ~(size_t)(0x1)));
+  }
+  return n;
+}
+
+// Check all pairs of "batch" (cones encoded) with as few calls as possible:
+// assume the disjunction of their miters. UNSAT proves every pair still
+// open; a model tells at least one of them apart (its PI values go to the
+// _cex of the first such pair) and the rest are tried again. If a batch
+// runs out of budget, its pairs are checked one at a time.
+// All clauses of the batch are added before its first call and retired
+// after its last one, so the calls in between only differ in their
+// assumptions: a pair told apart is dropped from the disjunction by
+// assuming its miter off, which extends the assumptions of the previous
+// call and lets the solver keep their levels.
+void
+CirMgr::solveBatch(SatSolver& solver, vector<FraigPair>& batch) const
+{
+  vector<Var> acts(batch.size());
+  vector<size_t> open(batch.size());
+  for (size_t k = 0; k < batch.size(); ++k) {
+    FraigPair& p = batch[k];
+    acts[k] = solver.newVar();
+    solver.addMiterCNF(acts[k], _cnfVar[p._rep->getId()], false,
+                       _cnfVar[p._gate->getId()], p._inv);
+    p._result = -1;
+    p._cex.clear();
+    open[k] = k;
+  }
+  Var any = var_Undef;
+  if (batch.size() > 1) {
+    any = solver.newVar();
+    solver.addOrCNF(any, acts);
+  }
+  vector<Var> apart;   // miters told apart, in the order they were
+  bool single = (any == var_Undef);
+  while (!open.empty()) {
+    solver.assumeRelease();
+    if (single)
+      solver.assumeProperty(acts[open[0]], true);
+    else {
+      solver.assumeProperty(any, true);
+      for (size_t k = 0; k < apart.size(); ++k)
+        solver.assumeProperty(apart[k], false);
+    }
+    int64 budget = batch[open[0]]._budget;
+    int result = solver.assumpSolveLimited(budget,
+                                           budget * PROPS_PER_CONFLICT);
+    const SatStats& call = solver.getLastCall();
+    _fraigStats->addCall(result, call, batch[open[0]]._gate->getId(),
+                         batch[open[0]]._rep->getId(),
+                         single? 1 : open.size());
+    if (result < 0 && !single) {
+      single = true;
+      continue;
+    }
+    if (result <= 0) {
+      size_t n = single? 1 : open.size();
+      for (size_t k = 0; k < n; ++k) {
+        batch[open[k]]._result = result;
+        batch[open[k]]._call = call;
+      }
+      open.erase(open.begin(), open.begin() + n);
+      continue;
+    }
+    size_t n = 0;
+    bool first = true;
+    for (size_t k = 0; k < open.size(); ++k) {
+      FraigPair& p = batch[open[k]];
+      if (solver.getValue(_cnfVar[p._rep->getId()]) ==
+          (solver.getValue(_cnfVar[p._gate->getId()]) ^ (int)p._inv)) {
+        open[n++] = open[k];
+        continue;
+      }
+      p._result = 1;
+      p._call = call;
+      apart.push_back(acts[open[k]]);
+      if (first) {
+        p._cex.resize(_piList.size());
+        for (size_t i = 0; i < _piList.size(); ++i)
+          p._cex[i] = (solver.getValue(_cnfVar[_piList[i]->getId()]) == 1);
+        first = false;
+      }
+    }
+    assert(n < open.size());
+    open.resize(n);
+  }
+  // retire the miters
+  if (any != var_Undef) solver.assertProperty(any, false);
+  for (size_t k = 0; k < acts.size(); ++k)
+    solver.assertProperty(acts[k], false);
+}
+
+// Index of the representative of "grp": the member with the lowest level,
+// then the fewest fanins, then the first one
+size_t
+CirMgr::pickRep(const IDList& grp, const vector<unsigned>& level) const
+{
+  size_t r = 0;
+  for (size_t j = 1; j < grp.size(); ++j) {
+    const CirGate* m = getGate(grp[j]/2);
+    const CirGate* best = getGate(grp[r]/2);
+    if (level[m->getId()] < level[best->getId()] ||
+        (level[m->getId()] == level[best->getId()] &&
+         m->_fanin.size() < best->_fanin.size()))
+      r = j;
+  }
+  return r;
+}
+
+// Replace "g" by "rep" (inverted if "inv") and take it out of its group.
+// "g" itself is only deleted at the end of fraig().
+void
+CirMgr::fraigMerge(CirGate* g, CirGate* rep, bool inv, GateList& merged,
+                   bool proven)
+{
+  CirGate* in[2];
+  in[0] = (CirGate*)(g->_fanin[0] & ~(size_t)(0x1));
+  in[1] = (CirGate*)(g->_fanin[1] & ~(size_t)(0x1));
+  --_params[4];
+
+  merge(g, rep, (size_t)inv, proven? "Fraig: " : "Simplifying: ");
+  // remove some NULL fanouts
+  for (size_t m = 0; m < 2; ++m) {
+    for (size_t n = 0; n < in[m]->_fanout.size(); ++n) {
+      if ( (CirGate*)(in[m]->_fanout[n] & ~(size_t)(0x1)) == g)
+        in[m]->_fanout.erase(in[m]->_fanout.begin()+n);
+    }
+    if (in[m]->getType() == UNDEF_GATE && in[m]->_fanout.size() == 0) {
+      _gateList[in[m]->getId()] = NULL;
+      delete in[m];
+    }
+  }
+  ////////////////////////////////////////////////////////////
+  _gateList[g->getId()] = NULL;
+  merged.push_back(g);
+  IDList* grp = g->_fecs;
+  g->_fecs = NULL;
+  for (size_t j = 0; grp && j < grp->size(); ++j)
+    if ((*grp)[j]/2 == g->getId()) { grp->erase(grp->begin() + j); break; }
+  if (_fraigStats && proven) ++_fraigStats->_nMerges;
+  else if (_fraigStats) ++_fraigStats->_nSimplified;
+  if (proven && myLog.verbose())
+    myLog.out() << "Updating by UNSAT... Total #FEC Group = "
+                << _fecList.size() << "\n";
+}
+
 void
 CirMgr::reportResult(const SatSolver &s, bool result, CirGate* c)
 {
   s.printStats();
   cout << (result? "SAT":"UNSAT") << endl;
   if (result) {
-    cout << s.getValue(c->_var) << endl;
+    cout << s.getValue(_cnfVar[c->getId()]) << endl;
   }
 }
 
 void
 CirMgr::clearFECs()
 {
-  for (size_t i = 0; i < _dfsList.size(); ++i) {
-    if (_dfsList[i]->_fecs)  _dfsList[i]->_fecs = NULL;
+  _fecList.clear();
+  for (size_t i = 0; i < _gateList.size(); ++i) {
+    if (_gateList[i] && _gateList[i]->_fecs)  _gateList[i]->_fecs = NULL;
   }
 }
 
+// A fresh solver with the heuristics chosen by CIRFraig
 void
-CirMgr::generateProofModel(SatSolver& solver)
+CirMgr::initSolver(SatSolver& solver) const
 {
-  _gateList[0]->_var = solver.newVar();
-  for (size_t i = 0; i < _dfsList.size(); ++i) {
-    if (_dfsList[i]->getType() == PI_GATE || _dfsList[i]->getType() == AIG_GATE) {
-      Var v = solver.newVar();
-      _dfsList[i]->_var = v;
-      if (_dfsList[i]->getType() == AIG_GATE) {
-        CirGate* in[2];
-        in[0] = (CirGate*)(_dfsList[i]->_fanin[0] & ~(size_t)(0x1));
-        in[1] = (CirGate*)(_dfsList[i]->_fanin[1] & ~(size_t)(0x1));
-        bool flag[2];
-        flag[0] = (((_dfsList[i]->_fanin[0])&1) == 1);
-        flag[1] = (((_dfsList[i]->_fanin[1])&1) == 1);
-        solver.addAigCNF(_dfsList[i]->_var, in[0]->_var, flag[0], in[1]->_var, flag[1]);
-      }
+  solver.initialize();
+  solver.setRestart(_satRestart);
+  solver.setPhaseSaving(_satPhaseSaving);
+}
+
+// Simplify the CNF of the solver set up by generateProofModel(). Frozen are
+// the Vars that may still show up in a clause or an assumption: CONST0, the
+// PIs (their values are read back), the gates still in a FEC group, and the
+// gates with a fanout not encoded yet. An eliminated gate loses its Var; if
+// a merge gives it new fanouts, encodeCone() encodes it anew.
+void
+CirMgr::preprocessCNF(SatSolver& solver)
+{
+  for (size_t i = 0; i < _cnfVar.size(); ++i) {
+    if (_cnfVar[i] < 0) continue;
+    const CirGate* g = _gateList[i];
+    bool frozen = g && (g->getType() != AIG_GATE || g->_fecs);
+    for (size_t j = 0; g && !frozen && j < g->_fanout.size(); ++j) {
+      const CirGate* out = (CirGate*)(g->_fanout[j] & ~(size_t)(0x1));
+      frozen = out->getType() == AIG_GATE && _cnfVar[out->getId()] < 0;
     }
+    solver.setFrozen(_cnfVar[i], frozen);
   }
+  solver.preprocess();
+  for (size_t i = 0; i < _cnfVar.size(); ++i)
+    if (_cnfVar[i] >= 0 && solver.isEliminated(_cnfVar[i])) _cnfVar[i] = -1;
+}
+
+// Only CONST0 and the PIs are encoded here; AIG gates are added by
+// encodeCone() when a check first needs them.
+void
+CirMgr::generateProofModel(SatSolver& solver)
+{
+  _cnfVar.assign(_gateList.size(), -1);
+  _cnfVar[0] = solver.newVar();
+  solver.assertProperty(_cnfVar[0], false);
+  // PIs outside the DFS list still need a Var for reading back patterns
+  for (size_t i = 0; i < _piList.size(); ++i)
+    _cnfVar[_piList[i]->getId()] = solver.newVar();
+}
+
+// Encode the cone of "g" into the solver set up by generateProofModel()
+void
+CirMgr::encodeCone(SatSolver& solver, CirGate* g)
+{
+  encodeCone(solver, g, _cnfVar);
+}
 
+// Add the clauses of every gate in the fanin cone of "g" that has no Var
+// in "vars" (indexed by gate ID, -1 for none) yet. A floating (UNDEF)
+// fanin, or a PI, becomes a free variable.
+void
+CirMgr::encodeCone(SatSolver& solver, CirGate* g, vector<Var>& vars) const
+{
+  if (vars[g->getId()] >= 0) return;
+  GateList stack(1, g);
+  while (!stack.empty()) {
+    CirGate* top = stack.back();
+    if (vars[top->getId()] >= 0) { stack.pop_back(); continue; }
+    bool ready = true;
+    for (size_t j = 0; j < top->_fanin.size(); ++j) {
+      CirGate* in = (CirGate*)(top->_fanin[j] & ~(size_t)(0x1));
+      if (vars[in->getId()] < 0) { stack.push_back(in); ready = false; }
+    }
+    if (!ready) continue;
+    stack.pop_back();
+    Var v = vars[top->getId()] = solver.newVar();
+    if (top->getType() != AIG_GATE) continue;
+    unsigned in0 = ((CirGate*)(top->_fanin[0] & ~(size_t)(0x1)))->getId();
+    unsigned in1 = ((CirGate*)(top->_fanin[1] & ~(size_t)(0x1)))->getId();
+    solver.addAigCNF(v, vars[in0], top->_fanin[0] & 1,
+                     vars[in1], top->_fanin[1] & 1);
+  }
 }
@@ -114,7 +114,7 @@ CirGate::reportGate() const
     // simValues
     s.clear();
     s << "= Value: ";
-    size_t value = _simValue;
+    size_t value = cirMgr->getSimValue(_id);
     for (int i = 0; i < 32; i++) {
       if (i && i % 4 == 0) s << "_";
       s << (value & 1);
@@ -32,7 +32,8 @@ class CirGate
     friend class CirPoGate;
     public:
         CirGate() {}
-        CirGate(int id = 0, int lineNum = 0): _id(id), _lineNum(lineNum){}
+        CirGate(int id = 0, int lineNum = 0): _id(id), _lineNum(lineNum),
+            _fecs(0), _flag(false) {}
         virtual ~CirGate() {}
 
         // Basic access methods
@@ -59,8 +60,6 @@ class CirGate
         vector<size_t> _fanin;
         vector<size_t> _fanout;
         IDList*        _fecs;
-        size_t         _simValue;
-        Var            _var;
         bool           _flag;
 };
 
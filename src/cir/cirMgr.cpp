@@ -371,6 +371,7 @@ CirMgr::readCircuit(const string& fileName)
     {   cerr << "Cannot open design \"" << fileName << "\"!!" << endl;
         return false;
     }
+    _simStateFile = fileName + ".sim";
 
     bool ok = true;
     try
@@ -585,6 +586,7 @@ CirMgr::readCircuit(const string& fileName)
  *********************/
 void CirMgr::buildDFSList()
 {   _dfsList.clear();
+    _simProgValid = false;
     bool flag[_params[0]+_params[3]+1];
     memset(flag, 0, sizeof(flag));
     for (int i = 0, n = _poList.size(); i < n; ++i)
@@ -670,10 +672,13 @@ void CirMgr::printFECPairs() const
 
 void
 CirMgr::writeAag(ostream& outfile) const
-{   // header
+{   // header; A counts only the AIGs written, i.e. those in DFSList
+    unsigned nAig = 0;
+    for (size_t i = 0, s = _dfsList.size(); i < s; ++i)
+        if (_dfsList[i]->getType() == AIG_GATE) ++nAig;
     outfile << "aag";
-    for (int i = 0; i < 5; ++i) outfile << " " << _params[i];
-    outfile << endl;
+    for (int i = 0; i < 4; ++i) outfile << " " << _params[i];
+    outfile << " " << nAig << endl;
 
     // PI
     for (size_t i = 0; i < _piList.size(); ++i)
@@ -13,6 +13,7 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <set>
 
 using namespace std;
 
@@ -23,11 +24,20 @@ using namespace std;
 
 extern CirMgr *cirMgr;
 
+// heuristics of the fraig solvers unless CIRFraig says otherwise
+static const RestartPolicy DEFAULT_SAT_RESTART = restart_Luby;
+static const bool DEFAULT_SAT_PHASE_SAVING = true;
+
 class CirMgr
 {
     public:
-        CirMgr() {}
-        ~CirMgr() {}
+        CirMgr(): _simLog(0), _nPatBuf(0), _simProgValid(false),
+                  _simSlotValid(false), _simStateTried(false),
+                  _fraigStats(0), _satRestart(DEFAULT_SAT_RESTART),
+                  _satPhaseSaving(DEFAULT_SAT_PHASE_SAVING) {}
+        ~CirMgr() {
+            for (size_t i = 0; i < _gateList.size(); ++i) delete _gateList[i];
+        }
 
         // Access functions
         // return '0' if "gid" corresponds to an undefined gate.
@@ -36,6 +46,11 @@ class CirMgr
             return (_gateList[gid]->getType() == UNDEF_GATE)? 0 : _gateList[gid];
         }
 
+        // Value of the last simulated word
+        size_t getSimValue(unsigned gid) const {
+            return (gid < _simSlot.size())? _simSlot[gid] : 0;
+        }
+
         // Get Max Num (M of MILOA)
         unsigned _maxNum() { return _params[0]; }
 
@@ -48,21 +63,69 @@ class CirMgr
         bool check(CirGate*);
 
         void optimize();
-        void merge(CirGate*, CirGate*, size_t, string);
+        void merge(CirGate*, CirGate*, size_t, const char*);
+        bool simplifyTarget(CirGate*, CirGate*&, size_t&) const;
         // Member functions about simulation
-        void randomSim();
+        void randomSim(size_t maxPatterns = 0, size_t maxSeconds = 0,
+                       size_t targetPairs = 0);
         void fileSim(ifstream&);
+        void guidedSim();
         void simulate(vector<size_t>*, size_t);
-        void collectValidFECs();
+        void simulateWord();
+        void simulateWord(size_t*) const;
+        void simulateEvents(const vector<size_t>&);
+        void scheduleFanouts(unsigned);
+        void compileSim();
+        void initFECs();
+        size_t collectValidFECs();
+        size_t splitGroups(vector<IDList>&, const size_t*) const;
+        void writeSimLog(size_t);
+        bool genGuidedPattern(SatSolver&, const IDList&, set<size_t>&);
+        void recordPattern(const SatSolver&);
+        void recordPattern(const vector<bool>&);
+        void flushPatterns();
         void setSimLog(ofstream *logFile) { _simLog = logFile; }
 
+        // Member functions about simulation state
+        size_t structHash() const;
+        bool loadSimState(bool asked = false);
+        bool saveSimState(size_t, bool) const;
+        void storeSimWord();
+
         // Member functions about fraig
         void strash();
         void printFEC() const;
-        void fraig();
+        void fraig(size_t nThreads = 1, bool pipelined = false, size_t batch = 1,
+                   size_t maxSeconds = 0, bool stats = false,
+                   ostream* dump = 0, bool csv = false);
+        void setSatHeuristics(RestartPolicy r, bool phaseSaving) {
+            _satRestart = r; _satPhaseSaving = phaseSaving;
+        }
+        void initSolver(SatSolver&) const;
+        void sweepConsts(const vector<unsigned>&, GateList&);
+        void fraigSerial(const vector<unsigned>&, GateList&, size_t);
+        void fraigParallel(size_t, const vector<unsigned>&, GateList&);
+        void fraigPipelined(size_t, const vector<unsigned>&, GateList&);
+        void runFraigJob(FraigJob&);
+        void runPipeJob(FraigJob&);
+        void runPipeSim(FraigPipe&);
+        void solvePair(FraigJob&, FraigPair&) const;
+        void solveBatch(SatSolver&, vector<FraigPair>&) const;
+        bool localProof(CirGate*, CirGate*, bool, vector<Var>&) const;
+        void recordPair(const FraigPair&) const;
+        size_t coneSize(const CirGate*, const CirGate*) const;
+        size_t pickRep(const IDList&, const vector<unsigned>&) const;
+        void fraigMerge(CirGate*, CirGate*, bool, GateList&, bool proven = true);
         void reportResult(const SatSolver&, bool, CirGate*);
         void clearFECs();
         void generateProofModel(SatSolver&);
+        void preprocessCNF(SatSolver&);
+        void encodeCone(SatSolver&, CirGate*);
+        void encodeCone(SatSolver&, CirGate*, vector<Var>&) const;
+
+        // Member functions about equivalence checking
+        bool buildMiter(const CirMgr&, const CirMgr&, bool byIndex = false);
+        void cec();
 
         // Member functions about circuit reporting
         void printSummary() const;
@@ -85,6 +148,28 @@ class CirMgr
         ofstream             *_simLog;
         vector<IDList>       _fecList; // FEC groups with ID*2 (the form of .aag file)
         vector<CirGate*>     _writeGateList;
+        vector<size_t>       _patBuf;   // SAT-generated patterns, one word per PI
+        size_t               _nPatBuf;  // # of valid bits in each _patBuf word
+        vector<SimInst>      _simProg;  // _dfsList lowered for simulation
+        vector<size_t>       _simSlot;  // simulation value of each gate ID
+        bool                 _simProgValid; // reset whenever _dfsList changes
+        bool                 _simSlotValid; // _simSlot agrees with _simProg
+        // event-driven simulation: levels, slot->reader fanouts, queues
+        vector<unsigned>     _simLevel;     // level of each _simProg entry
+        vector<unsigned>     _simFoStart;   // readers of slot s are _simFanout
+        vector<unsigned>     _simFanout;    //   [_simFoStart[s], _simFoStart[s+1])
+        vector<IDList>       _simEvents;    // pending _simProg entries by level
+        vector<bool>         _simQueued;
+        vector<vector<size_t> > _fileSimSlots; // _simSlot after each word
+                                               // of the last fileSim()
+        // simulation state kept in "<design>.sim" between sessions
+        string               _simStateFile;
+        bool                 _simStateTried; // load at most once per read
+        vector<size_t>       _simStore;     // distinguishing PI words
+        vector<Var>          _cnfVar;       // Var of each gate ID; -1: none
+        FraigStats*          _fraigStats;   // during fraig() only
+        RestartPolicy        _satRestart;   // of the fraig solvers
+        bool                 _satPhaseSaving;
 
 };
 
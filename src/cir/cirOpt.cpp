@@ -33,6 +33,7 @@ using namespace std;
 void
 CirMgr::sweep()
 {
+  size_t nRemoved = 0;
   for (size_t i = 0; i < _gateList.size(); ++i) {
     bool flag = false;
     if (_gateList[i] == NULL) continue;
@@ -52,8 +53,10 @@ CirMgr::sweep()
 
 
     if (!flag) {
-      cout << "Sweeping: " << _gateList[i]->getTypeStr();
-      cout << '(' << _gateList[i]->getId() << ") removed..." << endl;
+      if (myLog.verbose())
+        myLog.out() << "Sweeping: " << _gateList[i]->getTypeStr() << '('
+                    << _gateList[i]->getId() << ") removed...\n";
+      ++nRemoved;
       delete _gateList[i];
       _gateList[i] = NULL;
     }
@@ -64,6 +67,8 @@ CirMgr::sweep()
           fanout.erase(fanout.begin()+(j--));
     }
   }
+  if (nRemoved && myLog.summary())
+    myLog.out() << "Sweeping: " << nRemoved << " gates removed.\n";
 }
 
 bool
@@ -82,6 +87,7 @@ CirMgr::check(CirGate* g)
 void
 CirMgr::optimize()
 {
+  size_t nMerged = 0;
   for (size_t i =0; i < _dfsList.size(); ++i) {
     if (_dfsList[i]->getType() != AIG_GATE) continue;
     IDList& fanin = _dfsList[i]->_fanin;
@@ -89,25 +95,10 @@ CirMgr::optimize()
     in[0] = (CirGate*)(fanin[0] & ~(size_t)(0x1));
     in[1] = (CirGate*)(fanin[1] & ~(size_t)(0x1));
 
-    // one of the fanin is 0
-    if (fanin[0] == (size_t)_gateList[0] || fanin[1] == (size_t)_gateList[0]) {
-      merge(_dfsList[i], _gateList[0], 0, "Simplifying: ");
-    }
-    // one of the fanin is 1
-    else if (in[0] == _gateList[0] || in[1] == _gateList[0]) {
-      if (in[0] == _gateList[0]) merge(_dfsList[i], in[1], fanin[1]&1, "Simplifying: ");
-      else merge(_dfsList[i], in[0], fanin[0]&1, "Simplifying: ");
-    }
-    // both fanins are the same
-    else if (fanin[0] == fanin[1]) {
-      merge(_dfsList[i], in[0], fanin[0]&1, "Simplifying: ");
-    }
-    // one fanin is the inverse of the other
-    else if (in[0] == in[1]) {
-      merge(_dfsList[i], _gateList[0], 0, "Simplifying: ");
-    }
-    // none of the cases above
-    else continue;
+    CirGate* to;
+    size_t inv;
+    if (!simplifyTarget(_dfsList[i], to, inv)) continue;
+    merge(_dfsList[i], to, inv, "Simplifying: ");
 
     for (size_t j = 0; j < fanin.size(); ++j) {
       // clear the NULL fanouts of fanins
@@ -125,7 +116,10 @@ CirMgr::optimize()
     _gateList[_dfsList[i]->getId()] = NULL;
     delete _dfsList[i];
     --_params[4];
+    ++nMerged;
   }
+  if (nMerged && myLog.summary())
+    myLog.out() << "Simplifying: " << nMerged << " gates merged.\n";
   // rebuildDFS
   buildDFSList();
 }
@@ -134,11 +128,43 @@ CirMgr::optimize()
 /*   Private member functions about optimization   */
 /***************************************************/
 
+// If the AIG gate "g" is trivial (a constant or repeated fanin), return
+// true and the gate it reduces to in "to", inverted if "inv" is 1
+bool
+CirMgr::simplifyTarget(CirGate* g, CirGate*& to, size_t& inv) const
+{
+  const IDList& fanin = g->_fanin;
+  CirGate* in[2];
+  in[0] = (CirGate*)(fanin[0] & ~(size_t)(0x1));
+  in[1] = (CirGate*)(fanin[1] & ~(size_t)(0x1));
+
+  // one of the fanin is 0
+  if (fanin[0] == (size_t)_gateList[0] || fanin[1] == (size_t)_gateList[0]) {
+    to = _gateList[0]; inv = 0;
+  }
+  // one of the fanin is 1
+  else if (in[0] == _gateList[0] || in[1] == _gateList[0]) {
+    if (in[0] == _gateList[0]) { to = in[1]; inv = fanin[1]&1; }
+    else { to = in[0]; inv = fanin[0]&1; }
+  }
+  // both fanins are the same
+  else if (fanin[0] == fanin[1]) {
+    to = in[0]; inv = fanin[0]&1;
+  }
+  // one fanin is the inverse of the other
+  else if (in[0] == in[1]) {
+    to = _gateList[0]; inv = 0;
+  }
+  // none of the cases above
+  else return false;
+  return true;
+}
+
 // inv determine on the condition of optimization
 // inv is going to make the inverse bit right
 // so it need to use a XOR compute with the fanout's fanin's inverse bit
 void
-CirMgr::merge(CirGate* old, CirGate* New, size_t inv, string messege)
+CirMgr::merge(CirGate* old, CirGate* New, size_t inv, const char* messege)
 {
   for (size_t i = 0; i < old->_fanout.size(); ++i) {
     CirGate* out = (CirGate*)(old->_fanout[i] & ~(size_t)(0x1));
@@ -150,6 +176,7 @@ CirMgr::merge(CirGate* old, CirGate* New, size_t inv, string messege)
       }
     }
   }
-  cout << messege << New->getId() << " merging "
-    << (inv? "!":"") << old->getId() << "...\n";
+  if (myLog.verbose())
+    myLog.out() << messege << New->getId() << " merging "
+                << (inv? "!":"") << old->getId() << "...\n";
 }
@@ -11,9 +11,11 @@
 #include <iomanip>
 #include <algorithm>
 #include <cassert>
+#include <set>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
+#include "sat.h"
 #include <cmath>
 
 
@@ -40,62 +42,62 @@ class SimKey
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// guided simulation
+static const size_t MAX_GUIDED_ROUNDS = 4;  // stop earlier if no group splits
+static const size_t RARE_SIM_BITS     = 2;  // "rare" if seen <= 2 times in 64
+// file simulation: go event-driven if at most 1/4 of the PI words change;
+// the state after each word is kept for the next run if it takes at most
+// FILE_SIM_MAX_SLOTS words in all
+static const size_t EVENT_SIM_RATIO   = 4;
+static const size_t FILE_SIM_MAX_SLOTS = 1 << 23;
+// random simulation: stop once a window of rounds removes fewer pairs
+static const double MIN_SPLIT_RATE    = 0.001;
 
 /************************************************/
 /*   Public member functions about Simulation   */
 /************************************************/
+// Simulate 64 random patterns per round until one of the budgets is used
+// up (0 means no limit), at most "targetPairs" candidate pairs are left, or
+// the groups stop splitting: over the last "window" rounds, fewer than
+// MIN_SPLIT_RATE of the remaining pairs were broken up.
 void
-CirMgr::randomSim()
+CirMgr::randomSim(size_t maxPatterns, size_t maxSeconds, size_t targetPairs)
 {
-  size_t MAX_FAILS = 4 + log2(_dfsList.size()), nPatterns = 0;
-  IDList temp;
-  temp.push_back(0);
-  for (size_t i = 0; i < _dfsList.size(); ++i)
-    if (_dfsList[i]->getType() == AIG_GATE)
-      temp.push_back(2*_dfsList[i]->getId());
-  _fecList.push_back(temp);
-  while (nPatterns < MAX_FAILS) {
-    // set simValue
+  size_t window = 4 + log2(_dfsList.size()), nPatterns = 0;
+  double start = getWallTime();
+  compileSim();
+  initFECs();
+  size_t nPairs = 0;
+  for (size_t i = 0; i < _fecList.size(); ++i)
+    nPairs += _fecList[i].size() - 1;
+  vector<size_t> splits(window, 0);   // pairs removed in each recent round
+  size_t recent = 0;                  // sum of "splits"
+  for (size_t r = 0; nPairs > targetPairs; ++r) {
+    if (maxPatterns && nPatterns >= maxPatterns) break;
+    if (maxSeconds && getWallTime() - start >= maxSeconds) break;
+    size_t nBits = 64;
+    if (maxPatterns && maxPatterns - nPatterns < 64)
+      nBits = maxPatterns - nPatterns;
+    // set simValue; past the budget, the bits repeat pattern 0
+    size_t mask = (nBits == 64)? ~(size_t)0 : ((size_t)1 << nBits) - 1;
     for (size_t i = 0; i < _piList.size(); ++i) {
       // create randomValue
       size_t value = ((size_t)(rnGen(INT_MAX)) << 32) | (((size_t)(rnGen(INT_MAX))));
-      _piList[i]->_simValue = value;
-    }
-    for (size_t i = 0; i < _dfsList.size(); ++i) {
-      if (_dfsList[i]->getType() == AIG_GATE) {
-        CirGate* in[2];
-        in[0] = (CirGate*)(_dfsList[i]->_fanin[0] & ~(size_t)(0x1));
-        in[1] = (CirGate*)(_dfsList[i]->_fanin[1] & ~(size_t)(0x1));
-        size_t value[2];
-        value[0] = (((_dfsList[i]->_fanin[0])&1) ==1)? ~(in[0]->_simValue):in[0]->_simValue;
-        value[1] = (((_dfsList[i]->_fanin[1])&1) ==1)? ~(in[1]->_simValue):in[1]->_simValue;
-        _dfsList[i]->_simValue = value[0] & value[1];
-      }
-      else if (_dfsList[i]->getType() == PO_GATE) {
-        CirGate* in = (CirGate*)(_dfsList[i]->_fanin[0] & ~(size_t)(0x1));
-        _dfsList[i]->_simValue = (((_dfsList[i]->_fanin[0])&1) == 1)? ~(in->_simValue):in->_simValue;
-      }
-    }
-    // write simLog
-    if (_simLog != NULL) {
-      size_t mask = (size_t)(0x1);
-      for (size_t j = 0; j < _piList.size(); ++j) {
-        for (size_t k = 0; k < 64; ++k)
-          (*_simLog) << ((mask<<k) & (_piList[j]->_simValue));
-      }
-      (*_simLog) << ' ';
-      for (size_t j = 0; j < _poList.size(); ++j) {
-        for (size_t k = 0; k < 64; ++k)
-          (*_simLog) << ((mask<<k)&(_poList[j]->_simValue));
-      }
+      value = (value & mask) | ((value & 1)? ~mask : 0);
+      _simSlot[_piList[i]->getId()] = value;
     }
+    simulateWord();
+    writeSimLog(nBits);
+    nPatterns += nBits;
     // collectValidFECs
-    vector<IDList> oldFECs = _fecList;
-    collectValidFECs();
-    if (oldFECs == _fecList) nPatterns++;
+    size_t left = collectValidFECs();
+    if (left < nPairs) storeSimWord();
+    recent += (nPairs - left) - splits[r % window];
+    splits[r % window] = nPairs - left;
+    nPairs = left;
+    if (r + 1 >= window && recent <= nPairs * MIN_SPLIT_RATE) break;
   }
-  cout << "MAX_FAILS: " << MAX_FAILS << endl;
-  cout << nPatterns*64 << " patterns simulated.\n";
+  cout << nPatterns << " patterns simulated.\n";
 }
 
 void
@@ -126,15 +128,22 @@ CirMgr::fileSim(ifstream& patternFile)
     }
     for (size_t i = 0; i < (size_t)_params[1]; ++i) {
       if (nPatterns%64 == 0) pattern[i].push_back((size_t)(0x0));
-      pattern[i][nPatterns/64] = (pattern[i][nPatterns/64] << 1) | (size_t)(line[i] == '1');
+      pattern[i][nPatterns/64] |= (size_t)(line[i] == '1') << (nPatterns%64);
     }
     // convert inputs patterns
     ++nPatterns;
     patternFile >> line;
   }
+  // the unused bits of the last word repeat pattern 0
+  if (nPatterns%64) {
+    size_t mask = ((size_t)1 << (nPatterns%64)) - 1;
+    for (size_t i = 0; i < (size_t)_params[1]; ++i) {
+      size_t& w = pattern[i].back();
+      w = (w & mask) | ((pattern[i][0] & 1)? ~mask : 0);
+    }
+  }
   // start to simulate
-  for (size_t i = 0; i < _dfsList.size(); ++i)
-    _dfsList[i]->_simValue = (size_t)(0x0);
+  compileSim();
   if (!nPatterns) return;
   else {
     simulate(pattern, nPatterns);
@@ -142,107 +151,372 @@ CirMgr::fileSim(ifstream& patternFile)
   }
 }
 
+// Refine the existing FEC groups with patterns generated by SAT: for each
+// group, ask the solver for an input that separates the representative from
+// another member, or that drives the representative to its rarely-seen
+// value. Random simulation is run first if there are no groups to work on.
+void
+CirMgr::guidedSim()
+{
+  if (_fecList.empty()) randomSim();
+  SatSolver solver;
+  solver.initialize();
+  generateProofModel(solver);
+  size_t nPatterns = 0;
+  set<size_t> tried;    // solver calls already made; never repeated
+  for (size_t r = 0; r < MAX_GUIDED_ROUNDS && !_fecList.empty(); ++r) {
+    // work on a copy; flushing the buffer refines _fecList underneath
+    vector<IDList> grps = _fecList;
+    size_t found = 0;
+    for (size_t i = 0; i < grps.size(); ++i) {
+      if (genGuidedPattern(solver, grps[i], tried)) ++found;
+      if (_nPatBuf == 64) {
+        nPatterns += _nPatBuf;
+        flushPatterns();
+      }
+    }
+    nPatterns += _nPatBuf;
+    flushPatterns();
+    if (!found) break;
+  }
+  cout << nPatterns << " guided patterns simulated.\n";
+}
+
 /*************************************************/
 /*   Private member functions about Simulation   */
 /*************************************************/
 
+// Word i starts from the state after word i of the last run, if kept (see
+// _fileSimSlots), else from the state after word i-1; if only a few PI
+// words differ from those, just the changes are propagated.
 void
 CirMgr::simulate(vector<size_t>* pattern, size_t nPatterns)
 {
-  // initialize _fecList;
-  IDList temp;
-  temp.push_back(0);
-  for (size_t i = 0; i < _dfsList.size(); ++i)
-    if (_dfsList[i]->getType() == AIG_GATE)
-      temp.push_back(2*_dfsList[i]->getId());
-  vector<IDList> &FECGrps = _fecList;
-  FECGrps.push_back(temp);
+  initFECs();
+  size_t nWords = pattern[0].size();
+  bool keep = nWords * _simSlot.size() <= FILE_SIM_MAX_SLOTS;
+  if (keep) _fileSimSlots.resize(nWords);
+  else _fileSimSlots.clear();
   // procedure for a simulation
-  for (size_t i = 0; i < pattern[0].size(); ++i) {
+  vector<size_t> words(_piList.size());
+  for (size_t i = 0; i < nWords; ++i) {
+    if (keep) {
+      vector<size_t>& last = _fileSimSlots[i];
+      if (last.size() == _simSlot.size()) _simSlotValid = true;
+      else if (i) last = _fileSimSlots[i-1];
+      else last = _simSlot;
+      _simSlot.swap(last);
+    }
     // set simValue
-    for (size_t j = 0; j < _piList.size(); ++j)
-      _piList[j]->_simValue = pattern[j][i];
-    for (size_t j = 0; j < _dfsList.size(); ++j) {
-      if (_dfsList[j]->getType() == AIG_GATE) {
-        CirGate* in[2];
-        in[0] = (CirGate*)(_dfsList[j]->_fanin[0] & ~(size_t)(0x1));
-        in[1] = (CirGate*)(_dfsList[j]->_fanin[1] & ~(size_t)(0x1));
-        size_t value[2];
-        value[0] = (((_dfsList[j]->_fanin[0])&1) == 1)? ~(in[0]->_simValue):in[0]->_simValue;
-        value[1] = (((_dfsList[j]->_fanin[1])&1) == 1)? ~(in[1]->_simValue):in[1]->_simValue;
-        _dfsList[j]->_simValue = value[0] & value[1];
-      }
-      else if (_dfsList[j]->getType() == PO_GATE) {
-        CirGate* in = (CirGate*)(_dfsList[j]->_fanin[0] & ~(size_t)(0x1));
-        _dfsList[j]->_simValue = ((_dfsList[j]->_fanin[0]&1) == 1)? ~(in->_simValue):in->_simValue;
-      }
+    size_t nChanged = 0;
+    for (size_t j = 0; j < _piList.size(); ++j) {
+      words[j] = pattern[j][i];
+      if (_simSlot[_piList[j]->getId()] != words[j]) ++nChanged;
+    }
+    if (_simSlotValid && nChanged * EVENT_SIM_RATIO <= _piList.size())
+      simulateEvents(words);
+    else {
+      for (size_t j = 0; j < _piList.size(); ++j)
+        _simSlot[_piList[j]->getId()] = words[j];
+      simulateWord();
     }
     // write _simLog
-    if (_simLog != NULL) {
-      size_t mask = (size_t)(0x1);
-      for (size_t j = 0; j < _piList.size(); ++j) {
-        if (i != pattern[0].size()-1) {
-          for (size_t k = 0; k < 64; ++k)
-            (*_simLog) << ((mask<<k) & (_piList[j]->_simValue));
-        }
-        else {
-          for (size_t k = 0; k < nPatterns%64; ++k)
-            (*_simLog) << ((mask<<k)&(_piList[j]->_simValue));
-        }
-      }
-      (*_simLog) << ' ';
-      for (size_t j = 0; j < _poList.size(); ++j) {
-        if (i != pattern[0].size()-1) {
-          for (size_t k = 0; k < 64; ++k)
-            (*_simLog) << ((mask<<k)&(_poList[j]->_simValue));
-        }
-        else {
-          for (size_t k = 0; k < nPatterns%64; ++k)
-            (*_simLog) << ((mask<<k)&(_poList[j]->_simValue));
-        }
-      }
+    if (i == pattern[0].size()-1 && nPatterns%64) writeSimLog(nPatterns%64);
+    else writeSimLog(64);
+    // build FECs; keep the words that split something
+    size_t nPairs = 0;
+    for (size_t k = 0; k < _fecList.size(); ++k)
+      nPairs += _fecList[k].size() - 1;
+    if (collectValidFECs() < nPairs) storeSimWord();
+    if (keep) _simSlot.swap(_fileSimSlots[i]);
+  }
+  if (keep) _simSlot = _fileSimSlots[nWords-1];
+}
+
+// Evaluate one 64-bit word of patterns; PI slots must already be set.
+// Inversions are applied as XOR masks, so the loop has no branches.
+void
+CirMgr::simulateWord()
+{
+  simulateWord(&_simSlot[0]);
+  _simSlotValid = true;
+}
+
+// Same, on slots other than _simSlot (e.g. those of another thread)
+void
+CirMgr::simulateWord(size_t* v) const
+{
+  const SimInst* p = _simProg.empty()? 0 : &_simProg[0];
+  for (size_t i = 0, n = _simProg.size(); i < n; ++i, ++p)
+    v[p->_out] = (v[p->_in0] ^ (0 - (size_t)(p->_op & 1)))
+               & (v[p->_in1] ^ (0 - (size_t)(p->_op >> 1)));
+}
+
+// Set the PI words and re-evaluate only their transitive fanout, level by
+// level, stopping wherever a gate value does not change. _simSlot must hold
+// a consistent word already.
+void
+CirMgr::simulateEvents(const vector<size_t>& piWords)
+{
+  assert(_simSlotValid);
+  size_t* v = &_simSlot[0];
+  for (size_t i = 0; i < _piList.size(); ++i) {
+    unsigned id = _piList[i]->getId();
+    if (v[id] == piWords[i]) continue;
+    v[id] = piWords[i];
+    scheduleFanouts(id);
+  }
+  for (size_t lev = 1; lev < _simEvents.size(); ++lev) {
+    IDList& q = _simEvents[lev];
+    for (size_t k = 0; k < q.size(); ++k) {
+      _simQueued[q[k]] = false;
+      const SimInst& p = _simProg[q[k]];
+      size_t value = (v[p._in0] ^ (0 - (size_t)(p._op & 1)))
+                   & (v[p._in1] ^ (0 - (size_t)(p._op >> 1)));
+      if (value == v[p._out]) continue;
+      v[p._out] = value;
+      scheduleFanouts(p._out);
+    }
+    q.clear();
+  }
+}
+
+void
+CirMgr::scheduleFanouts(unsigned slot)
+{
+  for (unsigned k = _simFoStart[slot]; k < _simFoStart[slot+1]; ++k) {
+    unsigned inst = _simFanout[k];
+    if (_simQueued[inst]) continue;
+    _simQueued[inst] = true;
+    _simEvents[_simLevel[inst]].push_back(inst);
+  }
+}
+
+// Lower _dfsList into _simProg; only redone after the netlist has changed
+void
+CirMgr::compileSim()
+{
+  _simSlot.resize(_gateList.size(), 0);
+  if (_simProgValid) return;
+  _simProg.clear();
+  _simProg.reserve(_dfsList.size());
+  for (size_t i = 0; i < _dfsList.size(); ++i) {
+    CirGate* g = _dfsList[i];
+    if (g->getType() != AIG_GATE && g->getType() != PO_GATE) continue;
+    SimInst inst;
+    inst._out = g->getId();
+    inst._in0 = ((CirGate*)(g->_fanin[0] & ~(size_t)(0x1)))->getId();
+    inst._op = g->_fanin[0] & 1;
+    if (g->getType() == AIG_GATE) {
+      inst._in1 = ((CirGate*)(g->_fanin[1] & ~(size_t)(0x1)))->getId();
+      inst._op |= (g->_fanin[1] & 1) << 1;
     }
-    // build FECs
-    collectValidFECs();
+    else {  // PO: AND the fanin with itself
+      inst._in1 = inst._in0;
+      inst._op |= inst._op << 1;
+    }
+    _simProg.push_back(inst);
+  }
+  // levels (PIs and CONST0 are level 0) and fanouts for simulateEvents()
+  vector<unsigned> slotLevel(_simSlot.size(), 0);
+  _simLevel.resize(_simProg.size());
+  _simFoStart.assign(_simSlot.size()+1, 0);
+  unsigned maxLevel = 0;
+  for (size_t i = 0; i < _simProg.size(); ++i) {
+    const SimInst& p = _simProg[i];
+    unsigned lev = 1 + ((slotLevel[p._in0] > slotLevel[p._in1])?
+                        slotLevel[p._in0] : slotLevel[p._in1]);
+    _simLevel[i] = slotLevel[p._out] = lev;
+    if (lev > maxLevel) maxLevel = lev;
+    ++_simFoStart[p._in0+1];
+    if (p._in1 != p._in0) ++_simFoStart[p._in1+1];
   }
+  for (size_t s = 0; s < _simSlot.size(); ++s)
+    _simFoStart[s+1] += _simFoStart[s];
+  _simFanout.resize(_simFoStart.back());
+  vector<unsigned> fill(_simFoStart.begin(), _simFoStart.end()-1);
+  for (size_t i = 0; i < _simProg.size(); ++i) {
+    const SimInst& p = _simProg[i];
+    _simFanout[fill[p._in0]++] = i;
+    if (p._in1 != p._in0) _simFanout[fill[p._in1]++] = i;
+  }
+  _simEvents.assign(maxLevel+1, IDList());
+  _simQueued.assign(_simProg.size(), false);
+  _simProgValid = true;
+  _simSlotValid = false;
+  _fileSimSlots.clear();
 }
 
+// Put every AIG gate (and CONST0) into one group before the first
+// simulation; later simulations keep refining the existing groups.
 void
+CirMgr::initFECs()
+{
+  if (!_fecList.empty()) return;
+  IDList temp;
+  temp.push_back(0);
+  for (size_t i = 0; i < _dfsList.size(); ++i)
+    if (_dfsList[i]->getType() == AIG_GATE)
+      temp.push_back(2*_dfsList[i]->getId());
+  _fecList.push_back(temp);
+}
+
+// One line per pattern: PI bits, a space, then PO bits
+void
+CirMgr::writeSimLog(size_t nBits)
+{
+  if (_simLog == NULL) return;
+  for (size_t k = 0; k < nBits; ++k) {
+    for (size_t j = 0; j < _piList.size(); ++j)
+      (*_simLog) << ((_simSlot[_piList[j]->getId()] >> k) & 1);
+    (*_simLog) << ' ';
+    for (size_t j = 0; j < _poList.size(); ++j)
+      (*_simLog) << ((_simSlot[_poList[j]->getId()] >> k) & 1);
+    (*_simLog) << '\n';
+  }
+}
+
+// Split every group by the current simulation word, keeping the members in
+// order; return the number of candidate pairs (members minus groups) left.
+size_t
 CirMgr::collectValidFECs()
 {
-  size_t m = _fecList.size();
-  vector<IDList> newfec;
-  for (size_t i = 0; i < m; ++i) {
-    // Hashing
-    HashMap<SimKey, IDList> newFECGrps(getHashSize(_fecList[i].size()));
-    for (size_t j = 0, n = _fecList[i].size(); j < n; ++j) {
-      IDList temp;
+  for (size_t i = 0; i < _fecList.size(); ++i)
+    for (size_t j = 0; j < _fecList[i].size(); ++j)
+      getGate(_fecList[i][j]/2)->_fecs = NULL;
+  size_t nPairs = splitGroups(_fecList, &_simSlot[0]);
+  for (size_t i = 0; i < _fecList.size(); ++i) {
+    for (size_t j = 0; j < _fecList[i].size(); ++j) {
       CirGate* gate = getGate(_fecList[i][j]/2);
-      if (newFECGrps.check(gate->_simValue, temp)) {
-        temp.push_back(2*gate->getId());
-        newFECGrps.replaceInsert(gate->_simValue, temp);
-      }
-      else if (newFECGrps.check(~(gate->_simValue), temp)) {
-        temp.push_back(1+2*gate->getId());
-        newFECGrps.replaceInsert(~(gate->_simValue), temp);
-      }
+      gate->_fecs = &_fecList[i];
+    }
+  }
+  return nPairs;
+}
+
+// The work of collectValidFECs() on any groups and slot values; does not
+// touch the gates
+size_t
+CirMgr::splitGroups(vector<IDList>& grps, const size_t* v) const
+{
+  vector<IDList> newfec;
+  size_t nPairs = 0;
+  for (size_t i = 0, m = grps.size(); i < m; ++i) {
+    // Hashing: value (or its complement) -> index into newfec
+    size_t first = newfec.size();
+    HashMap<SimKey, size_t> newFECGrps(getHashSize(grps[i].size()));
+    for (size_t j = 0, n = grps[i].size(); j < n; ++j) {
+      size_t id = grps[i][j]/2, value = v[id], k;
+      if (newFECGrps.check(value, k))
+        newfec[k].push_back(2*id);
+      else if (newFECGrps.check(~value, k))
+        newfec[k].push_back(1+2*id);
       else {
-        temp.push_back(2*gate->getId());
-        newFECGrps.forceInsert(gate->_simValue, temp);
+        newFECGrps.forceInsert(value, newfec.size());
+        newfec.push_back(IDList(1, 2*id));
       }
     }
-    // collecting
-    for (HashMap<SimKey, IDList>::iterator nt = newFECGrps.begin(); nt != newFECGrps.end(); ++nt)
-      if ((*nt).second.size() != 1) {
-        newfec.push_back((*nt).second);
+    // collecting: drop the singletons
+    size_t last = first;
+    for (size_t k = first; k < newfec.size(); ++k)
+      if (newfec[k].size() != 1) {
+        nPairs += newfec[k].size() - 1;
+        if (k != last) newfec[last].swap(newfec[k]);
+        ++last;
       }
+    newfec.resize(last);
   }
-  _fecList.clear();
-  _fecList = newfec;
-  for (size_t i = 0; i < _fecList.size(); ++i) {
-    for (size_t j = 0; j < _fecList[i].size(); ++j) {
-      CirGate* gate = getGate(_fecList[i][j]/2);
-      gate->_fecs = &_fecList[i];
+  grps.swap(newfec);
+  return nPairs;
+}
+
+// Look for one pattern that splits "grp". Return true if a pattern is put
+// into the buffer. Every solver call is keyed into "tried" (member id *
+// #gates + representative id) and never made again.
+bool
+CirMgr::genGuidedPattern(SatSolver& solver, const IDList& grp,
+                         set<size_t>& tried)
+{
+  CirGate* rep = getGate(grp[0]/2);
+  if (rep == NULL) return false;
+  size_t nGates = _gateList.size();
+  // representative rarely takes one of its values: force the rare one
+  size_t key = rep->getId() * nGates + rep->getId();
+  if (rep->getType() != CONST_GATE && tried.find(key) == tried.end()) {
+    size_t ones = __builtin_popcountl(_simSlot[rep->getId()]);
+    if (ones <= RARE_SIM_BITS || ones >= 64 - RARE_SIM_BITS) {
+      tried.insert(key);
+      encodeCone(solver, rep);
+      solver.assumeRelease();
+      solver.assumeProperty(_cnfVar[rep->getId()], ones <= RARE_SIM_BITS);
+      if (solver.assumpSolve()) {
+        recordPattern(solver);
+        return true;
+      }
+    }
+  }
+  // make the representative differ from some other member
+  for (size_t k = 1; k < grp.size(); ++k) {
+    CirGate* g = getGate(grp[k]/2);
+    if (g == NULL) continue;
+    key = g->getId() * nGates + rep->getId();
+    if (tried.find(key) != tried.end()) continue;
+    tried.insert(key);
+    encodeCone(solver, rep);
+    encodeCone(solver, g);
+    Var act = solver.newVar();
+    solver.addMiterCNF(act, _cnfVar[rep->getId()], grp[0]%2 == 1,
+                       _cnfVar[g->getId()], grp[k]%2 == 1);
+    solver.assumeRelease();
+    solver.assumeProperty(act, true);
+    bool sat = solver.assumpSolve();
+    solver.assertProperty(act, false);   // retire the miter
+    if (sat) {
+      recordPattern(solver);
+      return true;
     }
+    // a proven pair hints that the group is real; leave it to fraig
+    break;
+  }
+  return false;
+}
+
+// Pack the PI values of the last SAT model into the pattern buffer
+void
+CirMgr::recordPattern(const SatSolver& solver)
+{
+  vector<bool> values(_piList.size());
+  for (size_t i = 0; i < _piList.size(); ++i)
+    values[i] = (solver.getValue(_cnfVar[_piList[i]->getId()]) == 1);
+  recordPattern(values);
+}
+
+void
+CirMgr::recordPattern(const vector<bool>& values)
+{
+  if (_patBuf.size() != _piList.size()) {
+    _patBuf.assign(_piList.size(), 0);
+    _nPatBuf = 0;
   }
+  assert(_nPatBuf < 64);
+  for (size_t i = 0; i < _piList.size(); ++i)
+    if (values[i])
+      _patBuf[i] |= (size_t)1 << _nPatBuf;
+  ++_nPatBuf;
+}
+
+// Simulate the buffered patterns as one word and refine the FEC groups
+void
+CirMgr::flushPatterns()
+{
+  if (_nPatBuf == 0) return;
+  compileSim();
+  for (size_t i = 0; i < _piList.size(); ++i)
+    _simSlot[_piList[i]->getId()] = _patBuf[i];
+  simulateWord();
+  writeSimLog(_nPatBuf);
+  storeSimWord();
+  collectValidFECs();
+  _patBuf.assign(_piList.size(), 0);
+  _nPatBuf = 0;
 }
@@ -0,0 +1,208 @@
+/****************************************************************************
+  FileName     [ cirSimState.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Save/restore simulation results across sessions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+// The sidecar file "<design>.sim" is a sequence of native 64-bit words:
+//
+//   MAGIC, structHash, #PI,
+//   #slots, signature of each gate ID     (#slots = 0: no signatures)
+//   #groups, { #members, members... }     (members as in _fecList)
+//   #words, #words * #PI pattern words    (word w of PI i at w * #PI + i)
+//
+// Signatures and groups are only used if the structural hash matches; for
+// an edited design with the same number of PIs (whatever its gate count)
+// the stored patterns are re-simulated.
+// The file is not meant to be portable across machines.
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const size_t SIM_STATE_MAGIC = 0x31544154534d4953ULL;  // "SIMSTAT1"
+static const size_t MAX_STORED_WORDS = 4096;  // x 64 patterns
+
+static inline void
+hashWord(size_t& h, size_t w)
+{
+  // FNV-1a over the 8 bytes of "w"
+  for (size_t b = 0; b < 8; ++b, w >>= 8) {
+    h ^= w & 0xff;
+    h *= 0x100000001b3ULL;
+  }
+}
+
+static inline void
+putWord(ofstream& f, size_t w)
+{
+  f.write((const char*)&w, sizeof(w));
+}
+
+static inline bool
+getWord(ifstream& f, size_t& w)
+{
+  return f.read((char*)&w, sizeof(w)).good();
+}
+
+/*******************************************************/
+/*   Public member functions about simulation state   */
+/*******************************************************/
+// Hash of the PIs, the AIG gates in DFS order and the PO drivers; equal
+// hashes mean the gate IDs (and so the signatures) can be reused
+size_t
+CirMgr::structHash() const
+{
+  size_t h = 0xcbf29ce484222325ULL;
+  hashWord(h, _piList.size());
+  for (size_t i = 0; i < _piList.size(); ++i)
+    hashWord(h, _piList[i]->getId());
+  for (size_t i = 0; i < _dfsList.size(); ++i) {
+    const CirGate* g = _dfsList[i];
+    if (g->getType() != AIG_GATE && g->getType() != PO_GATE) continue;
+    hashWord(h, g->getId());
+    for (size_t j = 0; j < g->_fanin.size(); ++j) {
+      const CirGate* in = (const CirGate*)(g->_fanin[j] & ~(size_t)(0x1));
+      hashWord(h, 2 * in->getId() + (g->_fanin[j] & 1));
+    }
+  }
+  return h;
+}
+
+// Restore the groups from the sidecar file before the first simulation of
+// a circuit: when "asked" (CIRSIMulate -Load), or as the CIRFraig fallback
+// for a circuit not yet simulated, at most once per read. Return true if
+// any FEC group results.
+bool
+CirMgr::loadSimState(bool asked)
+{
+  if (!_fecList.empty()) {
+    if (asked)
+      cerr << "Warning: circuit is already simulated; \"" << _simStateFile
+           << "\" is not loaded!!" << endl;
+    return false;
+  }
+  if (_simStateTried && !asked) return false;
+  _simStateTried = true;
+  ifstream f(_simStateFile.c_str(), ios::in | ios::binary);
+  if (!f) {
+    if (asked)
+      cerr << "Warning: cannot open simulation state \"" << _simStateFile
+           << "\"!!" << endl;
+    return false;
+  }
+
+  size_t magic, hash, nPI, nSlots, nGroups, nWords, w;
+  if (!getWord(f, magic) || magic != SIM_STATE_MAGIC ||
+      !getWord(f, hash) || !getWord(f, nPI) || nPI != _piList.size()) {
+    cerr << "Warning: ignoring simulation state \"" << _simStateFile
+         << "\" of another design!!" << endl;
+    return false;
+  }
+  // signatures and groups of a netlist with other gate IDs are skipped
+  bool ok = getWord(f, nSlots);
+  bool sameIds = ok && nSlots == _gateList.size();
+  vector<size_t> sigs;
+  vector<IDList> grps;
+  vector<size_t> words;
+  for (size_t i = 0; ok && i < nSlots; ++i)
+    if ((ok = getWord(f, w)) && sameIds) sigs.push_back(w);
+  ok = ok && getWord(f, nGroups);
+  for (size_t i = 0; ok && i < nGroups; ++i) {
+    size_t n;
+    ok = getWord(f, n);
+    if (sameIds) grps.push_back(IDList());
+    for (size_t j = 0; ok && j < n; ++j)
+      if ((ok = getWord(f, w)) && sameIds)
+        if ((ok = w/2 < _gateList.size())) grps.back().push_back(w);
+  }
+  ok = ok && getWord(f, nWords) && nWords <= MAX_STORED_WORDS;
+  words.resize(ok? nWords * nPI : 0);
+  for (size_t i = 0; ok && i < words.size(); ++i) ok = getWord(f, words[i]);
+  if (!ok) {
+    cerr << "Warning: simulation state \"" << _simStateFile
+         << "\" is corrupted!!" << endl;
+    return false;
+  }
+
+  compileSim();
+  _simStore = words;
+  if (sameIds && hash == structHash() && !grps.empty()) {
+    // same netlist: take everything as is
+    _simSlot = sigs;
+    _simSlotValid = true;
+    _fecList.swap(grps);
+    for (size_t i = 0; i < _fecList.size(); ++i)
+      for (size_t j = 0; j < _fecList[i].size(); ++j)
+        _gateList[_fecList[i][j]/2]->_fecs = &_fecList[i];
+    cout << "Restored " << _fecList.size() << " FEC groups from \""
+         << _simStateFile << "\".\n";
+  }
+  else if (nWords) {
+    // edited netlist: only the patterns are still meaningful
+    initFECs();
+    for (size_t w = 0; w < nWords; ++w) {
+      for (size_t i = 0; i < nPI; ++i)
+        _simSlot[_piList[i]->getId()] = words[w * nPI + i];
+      simulateWord();
+      collectValidFECs();
+    }
+    cout << nWords * 64 << " stored patterns re-simulated from \""
+         << _simStateFile << "\".\n";
+  }
+  return !_fecList.empty();
+}
+
+// Write the sidecar file under "key" (the structHash() of the netlist the
+// patterns were found on). Signatures and groups are written only if
+// "withFECs"; they must belong to the netlist of "key".
+bool
+CirMgr::saveSimState(size_t key, bool withFECs) const
+{
+  ofstream f(_simStateFile.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!f) {
+    cerr << "Error: cannot write simulation state \"" << _simStateFile
+         << "\"!!" << endl;
+    return false;
+  }
+  putWord(f, SIM_STATE_MAGIC);
+  putWord(f, key);
+  putWord(f, _piList.size());
+  if (withFECs) {
+    putWord(f, _simSlot.size());
+    for (size_t i = 0; i < _simSlot.size(); ++i) putWord(f, _simSlot[i]);
+    putWord(f, _fecList.size());
+    for (size_t i = 0; i < _fecList.size(); ++i) {
+      putWord(f, _fecList[i].size());
+      for (size_t j = 0; j < _fecList[i].size(); ++j)
+        putWord(f, _fecList[i][j]);
+    }
+  }
+  else {
+    putWord(f, 0);
+    putWord(f, 0);
+  }
+  size_t nWords = _piList.empty()? 0 : _simStore.size() / _piList.size();
+  putWord(f, nWords);
+  for (size_t i = 0; i < _simStore.size(); ++i) putWord(f, _simStore[i]);
+  return f.good();
+}
+
+// Remember the PI word just simulated as a distinguishing pattern
+void
+CirMgr::storeSimWord()
+{
+  if (_simStore.size() >= MAX_STORED_WORDS * _piList.size()) return;
+  for (size_t i = 0; i < _piList.size(); ++i)
+    _simStore.push_back(_simSlot[_piList[i]->getId()]);
+}
@@ -105,13 +105,22 @@ static inline int irand(double& seed, int size) {
 #ifdef _MSC_VER
 
 #include <ctime>
+#include <sys/timeb.h>
 
 static inline double cpuTime(void) {
     return (double)clock() / CLOCKS_PER_SEC; }
 
+static inline double wallTime(void) {
+    struct _timeb tb;
+    _ftime(&tb);
+    return (double)tb.time + (double)tb.millitm / 1000; }
+
 static inline int64 memUsed() {
     return 0; }
 
+static inline int64 memPeak() {
+    return 0; }
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 #else
 
@@ -138,8 +147,19 @@ static inline int memReadStat(int field)
     return value;
 }
 
+static inline double wallTime(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000; }
+
 static inline int64 memUsed() { return (int64)memReadStat(0) * (int64)getpagesize(); }
 
+// Peak resident set size of the process so far, in bytes
+static inline int64 memPeak() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (int64)ru.ru_maxrss * 1024; }
+
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 #endif
 
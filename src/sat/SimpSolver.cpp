@@ -0,0 +1,411 @@
+/**********************************************************************************[SimpSolver.C]
+MiniSat -- Copyright (c) 2003-2005, Niklas Een, Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include "SimpSolver.h"
+#include "Sort.h"
+
+
+//=================================================================================================
+// Helpers:
+
+
+// A 32-bit signature of the variables of a clause: if 'abst(C) & ~abst(D)' is non-zero, 'C' can
+// neither subsume nor strengthen 'D'.
+//
+static inline uint abstractLits(const vec<Lit>& ps)
+{
+    uint abst = 0;
+    for (int i = 0; i < ps.size(); i++)
+        abst |= 1 << (var(ps[i]) & 31);
+    return abst;
+}
+
+
+// Returns 'lit_Undef' if 'c' subsumes 'd', 'l' if 'd' can be strengthened by removing '~l' (a
+// literal 'l' of 'c'), and 'lit_Error' otherwise.
+//
+static Lit subsumes(const vec<Lit>& c, const vec<Lit>& d)
+{
+    Lit ret = lit_Undef;
+    for (int i = 0; i < c.size(); i++){
+        for (int j = 0; j < d.size(); j++){
+            if (c[i] == d[j])
+                goto ok;
+            else if (ret == lit_Undef && c[i] == ~d[j]){
+                ret = c[i];
+                goto ok; }
+        }
+        return lit_Error;
+    ok:;
+    }
+    return ret;
+}
+
+
+// Stores clause 'c' of an eliminated variable 'v' for 'extendModel()': the literal of 'v' first,
+// then the rest, then the size.
+//
+static void mkElimClause(vec<uint>& elimclauses, Var v, const vec<Lit>& c)
+{
+    int first = elimclauses.size();
+    int v_pos = -1;
+    for (int i = 0; i < c.size(); i++){
+        elimclauses.push(index(c[i]));
+        if (var(c[i]) == v)
+            v_pos = i + first;
+    }
+    assert(v_pos != -1);
+    uint tmp = elimclauses[v_pos];
+    elimclauses[v_pos] = elimclauses[first];
+    elimclauses[first] = tmp;
+    elimclauses.push(c.size());
+}
+
+
+static void mkElimClause(vec<uint>& elimclauses, Lit x)
+{
+    elimclauses.push(index(x));
+    elimclauses.push(1);
+}
+
+
+//=================================================================================================
+// Problem specification:
+
+
+Var SimpSolver::newVar()
+{
+    Var v = Solver::newVar();
+    frozen    .push(0);
+    eliminated.push(0);
+    merge_seen.push(0);
+    merge_seen.push(0);
+    return v;
+}
+
+
+//=================================================================================================
+// The working set of 'eliminate()':
+
+
+// Adds 'ps' unless it is satisfied at the top-level; false literals are left out. A unit is
+// enqueued right away.
+//
+void SimpSolver::addWorkingClause(const vec<Lit>& ps)
+{
+    int ci = cls.size();
+    cls.push();
+    vec<Lit>& c = cls.last();
+    for (int i = 0; i < ps.size(); i++){
+        if (value(ps[i]) == l_True){ c.clear(); cls.pop(); return; }
+        if (value(ps[i]) == l_Undef) c.push(ps[i]);
+    }
+    if (c.size() <= 1){
+        if (c.size() == 0 || !enqueue(c[0])) ok = false;
+        c.clear(); cls.pop();
+        return; }
+
+    cls_abst.push(abstractLits(c));
+    in_queue.push(1);
+    subsumption_queue.push(ci);
+    for (int i = 0; i < c.size(); i++)
+        occurs[var(c[i])].push(ci);
+}
+
+
+void SimpSolver::removeWorkingClause(int ci)
+{
+    cls[ci].clear(true);    // (the entries in 'occurs' go lazily)
+}
+
+
+// Removes 'l' from clause 'ci'. Returns FALSE on a top-level conflict.
+//
+bool SimpSolver::strengthen(int ci, Lit l)
+{
+    vec<Lit>& c = cls[ci];
+    int       i, j;
+    for (i = j = 0; i < c.size(); i++)
+        if (c[i] != l)
+            c[j++] = c[i];
+    c.shrink(i - j);
+    n_strengthened++;
+
+    if (c.size() == 1){
+        Lit unit = c[0];
+        removeWorkingClause(ci);
+        if (value(unit) == l_False || (value(unit) == l_Undef && !enqueue(unit)))
+            return ok = false;
+        return true; }
+
+    cls_abst[ci] = abstractLits(c);
+    if (!in_queue[ci]){
+        in_queue[ci] = 1;
+        subsumption_queue.push(ci); }
+    return true;
+}
+
+
+// Every clause in the queue removes the clauses it subsumes and strengthens those it can.
+//
+bool SimpSolver::backwardSubsumption()
+{
+    for (int qi = 0; qi < subsumption_queue.size(); qi++){
+        int ci = subsumption_queue[qi];
+        in_queue[ci] = 0;
+        if (cls[ci].size() == 0 || (subsumption_lim != -1 && cls[ci].size() > subsumption_lim))
+            continue;
+
+        // Search the occurrences of the variable that occurs the least:
+        Var best = var(cls[ci][0]);
+        for (int i = 1; i < cls[ci].size(); i++)
+            if (occurs[var(cls[ci][i])].size() < occurs[best].size())
+                best = var(cls[ci][i]);
+
+        for (int k = 0; k < occurs[best].size() && cls[ci].size() > 0; k++){
+            int di = occurs[best][k];
+            if (di == ci || cls[di].size() < cls[ci].size() || (cls_abst[ci] & ~cls_abst[di]) != 0)
+                continue;
+            Lit l = subsumes(cls[ci], cls[di]);
+            if (l == lit_Undef){
+                removeWorkingClause(di);
+                n_subsumed++;
+            }else if (l != lit_Error){
+                if (!strengthen(di, ~l))
+                    return false;
+            }
+        }
+    }
+    subsumption_queue.clear();
+    return true;
+}
+
+
+// Resolves 'ps' and 'qs' on 'v'. Returns FALSE if the resolvent is a tautology.
+//
+bool SimpSolver::merge(const vec<Lit>& ps, const vec<Lit>& qs, Var v, vec<Lit>& out)
+{
+    out.clear();
+    for (int i = 0; i < ps.size(); i++)
+        if (var(ps[i]) != v){
+            out.push(ps[i]);
+            merge_seen[index(ps[i])] = 1; }
+
+    bool taut = false;
+    for (int i = 0; i < qs.size() && !taut; i++){
+        if (var(qs[i]) == v || merge_seen[index(qs[i])])
+            continue;
+        if (merge_seen[index(~qs[i])])
+            taut = true;
+        else
+            out.push(qs[i]);
+    }
+
+    for (int i = 0; i < ps.size(); i++)
+        merge_seen[index(ps[i])] = 0;
+    return !taut;
+}
+
+
+// Replaces the clauses of 'v' by their resolvents on 'v' if there are no more of them (and none
+// is longer than 'clause_lim'). Returns FALSE on a top-level conflict.
+//
+bool SimpSolver::eliminateVar(Var v)
+{
+    // Split the occurrences by polarity (and clean the list on the way):
+    vec<int>&   occ = occurs[v];
+    vec<int>    pos, neg;
+    int         i, j;
+    for (i = j = 0; i < occ.size(); i++){
+        const vec<Lit>& c = cls[occ[i]];
+        int k = 0;
+        while (k < c.size() && var(c[k]) != v) k++;
+        if (k == c.size()) continue;
+        occ[j++] = occ[i];
+        if (sign(c[k])) neg.push(occ[i]);
+        else            pos.push(occ[i]);
+    }
+    occ.shrink(i - j);
+
+    // Count the resolvents:
+    vec<Lit>    resolvent;
+    int         cnt = 0;
+    for (i = 0; i < pos.size(); i++)
+        for (j = 0; j < neg.size(); j++)
+            if (merge(cls[pos[i]], cls[neg[j]], v, resolvent)
+            &&  (++cnt > pos.size() + neg.size() || (clause_lim != -1 && resolvent.size() > clause_lim)))
+                return true;
+
+    // Eliminate it:
+    eliminated[v] = 1;
+    setDecisionVar(v, false);
+    n_eliminated++;
+    if (pos.size() > neg.size()){
+        for (i = 0; i < neg.size(); i++)
+            mkElimClause(elimclauses, v, cls[neg[i]]);
+        mkElimClause(elimclauses, Lit(v));
+    }else{
+        for (i = 0; i < pos.size(); i++)
+            mkElimClause(elimclauses, v, cls[pos[i]]);
+        mkElimClause(elimclauses, ~Lit(v));
+    }
+
+    for (i = 0; i < pos.size(); i++)
+        for (j = 0; j < neg.size(); j++)
+            if (merge(cls[pos[i]], cls[neg[j]], v, resolvent)){
+                addWorkingClause(resolvent);
+                if (!ok) return false; }
+
+    for (i = 0; i < occ.size(); i++)
+        removeWorkingClause(occ[i]);
+    occ.clear(true);
+    return true;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  eliminate : [void]  ->  [bool]
+|
+|  Description:
+|    Take the problem clauses out of the solver, simplify them by subsumption and self-subsuming
+|    resolution, eliminate the variables that are not frozen where that does not increase the
+|    number of clauses, and add back what is left. Learnt clauses of eliminated variables are
+|    removed; the others stay valid. Binary learnt clauses cannot be told apart from problem ones
+|    in the watcher lists, and go back as problem clauses.
+|________________________________________________________________________________________________@*/
+bool SimpSolver::eliminate()
+{
+    simplifyDB();
+    if (!ok || proof != NULL) return ok;
+
+    // Top-level assignments need no reasons; they must not keep the clauses below alive:
+    for (int i = 0; i < trail.size(); i++)
+        reason[var(trail[i])] = GClause_NULL;
+
+    // Take out the problem clauses:
+    occurs.growTo(nVars());
+    for (int i = 0; i < clauses.size(); i++){
+        const Clause& c = ca[clauses[i]];
+        vec<Lit>      ps;
+        for (int k = 0; k < c.size(); k++) ps.push(c[k]);
+        addWorkingClause(ps);
+        remove(clauses[i]);
+    }
+    clauses.clear();
+    for (int p = 0; p < watches.size(); p++){
+        vec<Watcher>& ws = watches[p];
+        int           i, j;
+        for (i = j = 0; i < ws.size(); i++){
+            if (!ws[i].binary()){
+                ws[j++] = ws[i];
+                continue; }
+            // (each binary clause is in two lists; take it from the first)
+            Lit a = ~toLit(p), b = ws[i].blocker;
+            if (index(a) < index(b)){
+                vec<Lit> ps; ps.push(a); ps.push(b);
+                addWorkingClause(ps); }
+        }
+        ws.shrink(i - j);
+    }
+    n_bin_clauses = 0;
+    stats.clauses_literals = 0;
+    cleanWatches();
+
+    // Simplify:
+    for (int round = 0; ok && round < elim_rounds; round++){
+        if (!backwardSubsumption()) break;
+        if (!use_elim) break;
+
+        vec<Var> cands;
+        for (Var v = 0; v < nVars(); v++)
+            if (!frozen[v] && !eliminated[v] && value(v) == l_Undef)
+                cands.push(v);
+        int n_before = n_eliminated;
+        for (int i = 0; ok && i < cands.size(); i++){
+            if (value(cands[i]) != l_Undef) continue;
+            if (eliminateVar(cands[i]) && subsumption_queue.size() > 0)
+                backwardSubsumption();
+        }
+        if (n_eliminated == n_before) break;
+    }
+
+    // Put back what is left:
+    for (int i = 0; ok && i < cls.size(); i++)
+        if (cls[i].size() > 0)
+            Solver::addClause(cls[i]);
+    cls.clear(true);
+    cls_abst.clear(true);
+    occurs.clear(true);
+    subsumption_queue.clear(true);
+    in_queue.clear(true);
+    if (!ok) return false;
+
+    // Learnt clauses are implied by what is left unless they have an eliminated variable:
+    int i, j;
+    for (i = j = 0; i < learnts.size(); i++){
+        const Clause& c = ca[learnts[i]];
+        bool          drop = false;
+        for (int k = 0; k < c.size() && !drop; k++)
+            drop = eliminated[var(c[k])];
+        if (drop)
+            remove(learnts[i]);
+        else
+            learnts[j++] = learnts[i];
+    }
+    learnts.shrink(i - j);
+    cleanWatches();
+    checkGarbage();
+
+    if (propagate() != NULL) ok = false;
+    return ok;
+}
+
+
+//=================================================================================================
+// Solving:
+
+
+// The eliminated variables get values from their stored clauses, last eliminated first.
+//
+void SimpSolver::extendModel()
+{
+    int i, j;
+    Lit x;
+    for (i = elimclauses.size()-1; i > 0; i -= j){
+        for (j = elimclauses[i--]; j > 1; j--, i--){
+            Lit p = toLit(elimclauses[i]);
+            if ((sign(p) ? ~model[var(p)] : model[var(p)]) != l_False)
+                goto next;
+        }
+        x = toLit(elimclauses[i]);
+        model[var(x)] = sign(x) ? l_False : l_True;
+    next:;
+    }
+}
+
+
+lbool SimpSolver::solveLimited(const vec<Lit>& assumps)
+{
+    for (int i = 0; i < assumps.size(); i++) assert(!eliminated[var(assumps[i])]);
+    lbool status = Solver::solveLimited(assumps);
+    if (status == l_True && elimclauses.size() > 0)
+        extendModel();
+    return status;
+}
@@ -0,0 +1,102 @@
+/************************************************************************************[SimpSolver.h]
+MiniSat -- Copyright (c) 2003-2005, Niklas Een, Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef SimpSolver_h
+#define SimpSolver_h
+
+#include "Solver.h"
+
+
+//=================================================================================================
+// SimpSolver -- 'Solver' with SatELite style preprocessing of the problem clauses:
+//
+// 'eliminate()' takes the problem clauses out of the solver, applies subsumption, self-subsuming
+// resolution and bounded variable elimination to them and puts the result back. It may be called
+// again between incremental calls to 'solve()'. A variable that is still to appear in a clause or
+// an assumption added later must be frozen first ('setFrozen()'); the others may be eliminated,
+// and must not be used again. Models are extended to the eliminated variables.
+
+
+class SimpSolver : public Solver {
+public:
+    SimpSolver() : use_elim        (true)
+                 , clause_lim      (20)
+                 , subsumption_lim (1000)
+                 , elim_rounds     (3)
+                 , n_eliminated    (0)
+                 , n_subsumed      (0)
+                 , n_strengthened  (0)
+                 { }
+
+    // Problem specification:
+    //
+    Var     newVar      ();
+    void    addClause   (const vec<Lit>& ps, bool A = true) {
+        for (int i = 0; i < ps.size(); i++) assert(!eliminated[var(ps[i])]);
+        Solver::addClause(ps, A); }
+
+    // Preprocessing:
+    //
+    void    setFrozen   (Var v, bool b) { frozen[v] = (char)b; }
+    bool    isEliminated(Var v) const   { return eliminated[v]; }
+    bool    eliminate   ();             // Returns 'okay()'. Does nothing in proof logging mode.
+
+    // Solving: (the same as 'Solver's, but models cover the eliminated variables)
+    //
+    lbool   solveLimited(const vec<Lit>& assumps);
+    bool    solve       (const vec<Lit>& assumps) { budgetOff(); return solveLimited(assumps) == l_True; }
+    bool    solve       ()                        { vec<Lit> tmp; return solve(tmp); }
+
+    // Mode of operation:
+    //
+    bool    use_elim;           // Eliminate variables (otherwise only subsumption and self-subsuming resolution).
+    int     clause_lim;         // A variable is not eliminated if that produces a resolvent longer than this (-1 means no limit).
+    int     subsumption_lim;    // Do not look for clauses subsumed by a clause longer than this (-1 means no limit).
+    int     elim_rounds;        // Passes over the variables in one call to 'eliminate()'.
+
+    // Statistics:
+    //
+    int     n_eliminated, n_subsumed, n_strengthened;
+
+protected:
+    vec<char>           frozen;           // 'frozen[var]' is TRUE if 'var' must not be eliminated.
+    vec<char>           eliminated;       // 'eliminated[var]' is TRUE once 'var' is eliminated.
+    vec<uint>           elimclauses;      // The removed clauses of each eliminated variable (see 'extendModel()').
+
+    // The problem clauses while 'eliminate()' works on them:
+    //
+    vec<vec<Lit> >      cls;              // (a removed clause is left empty)
+    vec<uint>           cls_abst;         // Signature of each clause (see 'abstractLits()').
+    vec<vec<int> >      occurs;           // 'occurs[var]' lists the clauses with 'var' in either polarity (lazily cleaned).
+    vec<int>            subsumption_queue;
+    vec<char>           in_queue;         // 'in_queue[clause]' is TRUE if the clause is in 'subsumption_queue'.
+    vec<char>           merge_seen;       // (by literal index)
+
+    void    addWorkingClause   (const vec<Lit>& ps);
+    void    removeWorkingClause(int ci);
+    bool    strengthen         (int ci, Lit l);
+    bool    backwardSubsumption();
+    bool    merge              (const vec<Lit>& ps, const vec<Lit>& qs, Var v, vec<Lit>& out);
+    bool    eliminateVar       (Var v);
+    void    extendModel        ();
+};
+
+
+//=================================================================================================
+#endif
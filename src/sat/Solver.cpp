@@ -23,20 +23,6 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 int effLimit = INT_MAX;
 
-//=================================================================================================
-// Helper functions:
-
-
-void removeWatch(vec<Clause*>& ws, Clause* elem)
-{
-    if (ws.size() == 0) return;     // (skip lists that are already cleared)
-    int j = 0;
-    for (; ws[j] != elem  ; j++) assert(j < ws.size());
-    for (; j < ws.size()-1; j++) ws[j] = ws[j+1];
-    ws.pop();
-}
-
-
 //=================================================================================================
 // Operations on clauses:
 
@@ -67,7 +53,7 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
 
     vec<Lit>    qs;
     if (!learnt){
-        assert(decisionLevel() == 0);
+        cancelUntil(0);                     // (drop the assumptions kept from the last 'solve()')
         ps_.copyTo(qs);                     // Make a copy of the input vector.
 
         // Remove duplicates:
@@ -104,9 +90,22 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
         if (!enqueue(ps[0]))
             ok = false;
 
+    }else if (ps.size() == 2 && proof == NULL){
+        // Binary clause: inline it into the watcher lists, no 'Clause' is allocated (a proof needs the ID):
+        watches[index(~ps[0])].push(Watcher(CRef_Undef, ps[1]));
+        watches[index(~ps[1])].push(Watcher(CRef_Undef, ps[0]));
+        if (learnt){
+            check(enqueue(ps[0], GClause_new(ps[1])));
+            stats.learnts_literals += ps.size();
+        }else{
+            n_bin_clauses++;
+            stats.clauses_literals += ps.size();
+        }
+
     }else{
         // Allocate clause:
-        Clause* c   = Clause_new(learnt, ps, id);
+        CRef    cr  = ca.alloc(learnt, ps, id);
+        Clause* c   = ca.lea(cr);
 
         if (learnt){
             // Put the second watch on the literal with highest decision level:
@@ -122,41 +121,50 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
             // Bumping:
             claBumpActivity(c); // (newly learnt clauses should be considered active)
 
+            // Glue: the asserting literal is unassigned by now, but 'level[]' still holds the
+            // (unique) conflict level:
+            c->setGlue(computeLBD(ps));
+
             // Enqueue asserting literal:
-            check(enqueue((*c)[0], c));
+            check(enqueue((*c)[0], GClause_new(cr)));
 
             // Store clause:
-            watches[index(~(*c)[0])].push(c);
-            watches[index(~(*c)[1])].push(c);
-            learnts.push(c);
+            watches[index(~(*c)[0])].push(Watcher(cr, (*c)[1]));
+            watches[index(~(*c)[1])].push(Watcher(cr, (*c)[0]));
+            learnts.push(cr);
             stats.learnts_literals += c->size();
 
         }else{
             // Store clause:
-            watches[index(~(*c)[0])].push(c);
-            watches[index(~(*c)[1])].push(c);
-            clauses.push(c);
+            watches[index(~(*c)[0])].push(Watcher(cr, (*c)[1]));
+            watches[index(~(*c)[1])].push(Watcher(cr, (*c)[0]));
+            clauses.push(cr);
             stats.clauses_literals += c->size();
         }
     }
 }
 
 
-// Disposes a clauses and removes it from watcher lists. NOTE! Low-level; does NOT change the 'clauses' and 'learnts' vector.
+// Disposes a clause. Its watchers are only marked for removal; 'cleanWatches()' must be called
+// before the next propagation. NOTE! Low-level; does NOT change the 'clauses' and 'learnts' vector.
 //
-void Solver::remove(Clause* c, bool just_dealloc)
+void Solver::remove(CRef cr)
 {
-    if (!just_dealloc){
-        removeWatch(watches[index(~(*c)[0])], c),
-        removeWatch(watches[index(~(*c)[1])], c);
+    Clause& c = ca[cr];
+    for (int k = 0; k < 2; k++){
+        Lit p = ~c[k];
+        if (!watch_dirty[index(p)]){
+            watch_dirty[index(p)] = 1;
+            watch_dirties.push(p); }
+    }
 
-        if (c->learnt()) stats.learnts_literals -= c->size();
-        else             stats.clauses_literals -= c->size();
+    if (c.learnt()) stats.learnts_literals -= c.size();
+    else            stats.clauses_literals -= c.size();
 
-        if (proof != NULL) proof->deleted(c->id());
-    }
+    if (proof != NULL) proof->deleted(c.id());
 
-    xfree(c);
+    c.setDeleted();
+    ca.free(cr);
 }
 
 
@@ -164,17 +172,74 @@ void Solver::remove(Clause* c, bool just_dealloc)
 // the clause is binary and satisfied, in which case the first literal is true)
 // Returns True if clause is satisfied (will be removed), False otherwise.
 //
-bool Solver::simplify(Clause* c) const
+bool Solver::simplify(const Clause& c) const
 {
     assert(decisionLevel() == 0);
-    for (int i = 0; i < c->size(); i++){
-        if (value((*c)[i]) == l_True)
+    for (int i = 0; i < c.size(); i++){
+        if (value(c[i]) == l_True)
             return true;
     }
     return false;
 }
 
 
+// Drop the watchers of removed clauses from the lists 'remove()' marked.
+//
+void Solver::cleanWatches()
+{
+    for (int k = 0; k < watch_dirties.size(); k++){
+        int           p  = index(watch_dirties[k]);
+        vec<Watcher>& ws = watches[p];
+        int           i, j;
+        for (i = j = 0; i < ws.size(); i++)
+            if (ws[i].binary() || !ca[ws[i].cref].deleted())
+                ws[j++] = ws[i];
+        ws.shrink(i - j);
+        watch_dirty[p] = 0;
+    }
+    watch_dirties.clear();
+}
+
+
+// Move every live clause into a fresh region and update all references to them (watchers,
+// reasons, 'clauses' and 'learnts'). No 'Clause*' may be held across this call.
+//
+void Solver::relocAll(ClauseAllocator& to)
+{
+    cleanWatches();
+    for (int p = 0; p < watches.size(); p++){
+        vec<Watcher>& ws = watches[p];
+        for (int k = 0; k < ws.size(); k++)
+            if (!ws[k].binary())
+                ca.reloc(ws[k].cref, to);
+    }
+
+    // (a reason is never removed while its variable is assigned: it is 'locked()')
+    for (int k = 0; k < trail.size(); k++){
+        Var     x = var(trail[k]);
+        GClause r = reason[x];
+        if (r != GClause_NULL && !r.isLit()){
+            CRef cr = r.clause();
+            ca.reloc(cr, to);
+            reason[x] = GClause_new(cr); }
+    }
+
+    for (int k = 0; k < learnts.size(); k++) ca.reloc(learnts[k], to);
+    for (int k = 0; k < clauses.size(); k++) ca.reloc(clauses[k], to);
+}
+
+
+void Solver::garbageCollect()
+{
+    ClauseAllocator to(ca.size() - ca.wasted());
+    relocAll(to);
+    if (verbosity >= 2)
+        reportf("|  Garbage collection:   %12d bytes => %12d bytes             |\n",
+                (int)(ca.size() * sizeof(uint)), (int)(to.size() * sizeof(uint)));
+    to.moveTo(ca);
+}
+
+
 //=================================================================================================
 // Minor methods:
 
@@ -187,13 +252,18 @@ Var Solver::newVar() {
     index = nVars();
     watches     .push();          // (list for positive literal)
     watches     .push();          // (list for negative literal)
-    reason      .push(NULL);
+    watch_dirty .push(0);
+    watch_dirty .push(0);
+    reason      .push(GClause_NULL);
+    polarity    .push(1);
     assigns     .push(toInt(l_Undef));
     level       .push(-1);
     trail_pos   .push(-1);
     activity    .push(0);
+    decision    .push(1);
     order       .newVar();
     analyze_seen.push(0);
+    lbd_stamp   .push(0);         // (levels go up to 'nVars()')
     if (proof != NULL) unit_id.push(ClauseId_NULL);
     return index; }
 
@@ -209,11 +279,13 @@ void Solver::cancelUntil(int level) {
     if (decisionLevel() > level){
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var     x  = var(trail[c]);
-            assigns[x] = toInt(l_Undef);
-            reason [x] = NULL;
+            assigns [x] = toInt(l_Undef);
+            reason  [x] = GClause_NULL;
+            polarity[x] = sign(trail[c]);
             order.undo(x); }
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+        if (assumed.size() > level) assumed.shrink(assumed.size() - level);
         qhead = trail.size(); } }
 
 
@@ -260,8 +332,13 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         assert(confl != NULL);  // (otherwise should be UIP)
 
         Clause& c = *confl;
-        if (c.learnt())
+        if (c.learnt()){
             claBumpActivity(&c);
+            c.setUsed(true);
+            if (c.glue() > core_glue){
+                int glue = computeLBD(c);
+                if (glue < c.glue()) c.setGlue(glue); }
+        }
 
         for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
             Lit q = c[j];
@@ -283,7 +360,7 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         // Select next clause to look at:
         while (!seen[var(trail[index--])]);
         p     = trail[index+1];
-        confl = reason[var(p)];
+        confl = reasonOf(var(p), analyze_tmpbin);
         seen[var(p)] = 0;
         pathC--;
         if (pathC == 0) break;
@@ -304,14 +381,14 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 
         analyze_toclear.clear();
         for (i = j = 1; i < out_learnt.size(); i++)
-            if (reason[var(out_learnt[i])] == NULL || !analyze_removable(out_learnt[i], min_level))
+            if (reason[var(out_learnt[i])] == GClause_NULL || !analyze_removable(out_learnt[i], min_level))
                 out_learnt[j++] = out_learnt[i];
     }else if(expensive_ccmin == 1){
         // Simplify conflict clause (a little):
         //
         analyze_toclear.clear();
         for (i = j = 1; i < out_learnt.size(); i++){
-            Clause* r = reason[var(out_learnt[i])];
+            Clause* r = reasonOf(var(out_learnt[i]), analyze_tmpbin);
             if (r == NULL)
                 out_learnt[j++] = out_learnt[i];
             else{
@@ -334,7 +411,7 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         for (int k = 0; k < analyze_toclear.size(); k++){
             Var     v = var(analyze_toclear[k]); assert(level[v] > 0);
 				Lit     l = analyze_toclear[k];
-            Clause& c = *reason[v];
+            Clause& c = ca[reason[v].clause()];    // (no inlined binary clauses when logging a proof)
             proof->resolve(c.id(), l);
             for (int k = 1; k < c.size(); k++)
                 if (level[var(c[k])] == 0)
@@ -357,17 +434,17 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 //
 bool Solver::analyze_removable(Lit p, uint min_level)
 {
-    assert(reason[var(p)] != NULL);
+    assert(reason[var(p)] != GClause_NULL);
     analyze_stack.clear(); analyze_stack.push(p);
     int top = analyze_toclear.size();
     while (analyze_stack.size() > 0){
-        assert(reason[var(analyze_stack.last())] != NULL);
-        Clause& c = *reason[var(analyze_stack.last())];
+        assert(reason[var(analyze_stack.last())] != GClause_NULL);
+        Clause& c = *reasonOf(var(analyze_stack.last()), analyze_tmpbin);
         analyze_stack.pop();
         for (int i = 1; i < c.size(); i++){
             Lit p = c[i];
             if (!analyze_seen[var(p)] && level[var(p)] != 0){
-                if (reason[var(p)] != NULL && ((1 << (level[var(p)] & 31)) & min_level) != 0){
+                if (reason[var(p)] != GClause_NULL && ((1 << (level[var(p)] & 31)) & min_level) != 0){
                     analyze_seen[var(p)] = 1;
                     analyze_stack.push(p);
                     analyze_toclear.push(p);
@@ -420,7 +497,7 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
         Var     x = var(trail[i]);
 		  Lit     l = trail[i];
         if (seen[x]){
-            Clause* r = reason[x];
+            Clause* r = reasonOf(x, analyze_tmpbin);
             if (r == NULL){
                 assert(level[x] > 0);
                 conflict.push(~trail[i]);
@@ -451,12 +528,12 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
 |  Input:
 |    p    - The fact to enqueue
 |    from - [Optional] Fact propagated from this (currently) unit clause. Stored in 'reason[]'.
-|           Default value is NULL (no reason).
+|           Default value is GClause_NULL (no reason).
 |  
 |  Output:
 |    TRUE if fact was enqueued without conflict, FALSE otherwise.
 |________________________________________________________________________________________________@*/
-bool Solver::enqueue(Lit p, Clause* from)
+bool Solver::enqueue(Lit p, GClause from)
 {
     if (value(p) != l_Undef)
         return value(p) != l_False;
@@ -480,6 +557,7 @@ bool Solver::enqueue(Lit p, Clause* from)
 |  Description:
 |    Propagates all enqueued facts. If a conflict arises, the conflicting clause is returned,
 |    otherwise NULL. NOTE! This method has been optimized for speed rather than readability.
+|    The clause returned is only valid until the next clause is allocated (or collected).
 |  
 |    Post-conditions:
 |      * The propagation queue is empty, even if there was a conflict.
@@ -492,11 +570,33 @@ Clause* Solver::propagate()
         simpDB_props--;
 
         Lit            p  = trail[qhead++];     // 'p' is enqueued fact to propagate.
-        vec<Clause*>&  ws = watches[index(p)];
-        Clause**       i,** j,** end;
+        vec<Watcher>&  ws = watches[index(p)];
+        Watcher        *i, *j, *end;
+
+        for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
+            // If the blocker is true, the clause is satisfied; don't look at it.
+            if (value(i->blocker) == l_True){
+                *j++ = *i++;
+                continue; }
+
+            // Inlined binary clause: the blocker is implied (or false: conflict).
+            if (i->binary()){
+                Lit q = i->blocker;
+                *j++ = *i++;
+                if (!enqueue(q, GClause_new(~p))){
+                    if (decisionLevel() == 0)
+                        ok = false;
+                    confl = propagate_tmpbin;
+                    (*confl)[0] = q; (*confl)[1] = ~p;
+                    qhead = trail.size();
+                    // Copy the remaining watches:
+                    while (i < end)
+                        *j++ = *i++;
+                }
+                continue; }
 
-        for (i = j = (Clause**)ws, end = i + ws.size();  i != end;){
-            Clause& c = **i; i++;
+            CRef    cr = i->cref;
+            Clause& c  = ca[cr]; i++;
             // Make sure the false literal is data[1]:
             Lit false_lit = ~p;
             if (c[0] == false_lit)
@@ -504,17 +604,18 @@ Clause* Solver::propagate()
 
             assert(c[1] == false_lit);
 
-            // If 0th watch is true, then clause is already satisfied.
-            Lit   first = c[0];
-            lbool val   = value(first);
+            // If 0th watch is true, then clause is already satisfied (and it is the better blocker).
+            Lit     first = c[0];
+            Watcher w(cr, first);
+            lbool   val   = value(first);
             if (val == l_True){
-                *j++ = &c;
+                *j++ = w;
             }else{
                 // Look for new watch:
                 for (int k = 2; k < c.size(); k++)
                     if (value(c[k]) != l_False){
                         c[1] = c[k]; c[k] = false_lit;
-                        watches[index(~c[1])].push(&c);
+                        watches[index(~c[1])].push(w);
                         goto FoundWatch; }
 
                 // Did not find watch -- clause is unit under assignment:
@@ -535,8 +636,8 @@ Clause* Solver::propagate()
                     }
                 }
 					 
-                *j++ = &c;
-                if (!enqueue(first, &c)){
+                *j++ = w;
+                if (!enqueue(first, GClause_new(cr))){
                     if (decisionLevel() == 0)
                         ok = false;
                     confl = &c;
@@ -560,29 +661,47 @@ Clause* Solver::propagate()
 |  reduceDB : ()  ->  [void]
 |  
 |  Description:
-|    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
-|    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|    Learnt clauses come in three tiers by glue (LBD): core clauses (glue <= 'core_glue') are
+|    always kept; tier 2 clauses (glue <= 'tier2_glue') are kept if they took part in a conflict
+|    since the last call, otherwise they age into the local tier. Of the local clauses, the less
+|    active half is removed, minus the clauses locked by the current assignment. Locked clauses
+|    are clauses that are reason to some assignment. Binary clauses are never removed.
 |________________________________________________________________________________________________@*/
-struct reduceDB_lt { bool operator () (Clause* x, Clause* y) { return x->size() > 2 && (y->size() == 2 || x->activity() < y->activity()); } };
+struct reduceDB_lt {
+    ClauseAllocator& ca;
+    int              core_glue, tier2_glue;
+    reduceDB_lt(ClauseAllocator& ca_, int c, int t) : ca(ca_), core_glue(c), tier2_glue(t) {}
+    bool kept(const Clause& c) const {
+        return c.size() == 2 || c.glue() <= core_glue || (c.glue() <= tier2_glue && c.used()); }
+    // Local clauses first, less active first:
+    bool operator () (CRef x, CRef y) {
+        bool kx = kept(ca[x]), ky = kept(ca[y]);
+        return (kx != ky) ? ky : ca[x].activity() < ca[y].activity(); } };
 void Solver::reduceDB()
 {
-    int     i, j;
-    double  extra_lim = cla_inc / learnts.size();    // Remove any clause below this activity
-
-    sort(learnts, reduceDB_lt());
-    for (i = j = 0; i < learnts.size() / 2; i++){
-        if (learnts[i]->size() > 2 && !locked(learnts[i]))
-            remove(learnts[i]);
-        else
-            learnts[j++] = learnts[i];
-    }
-    for (; i < learnts.size(); i++){
-        if (learnts[i]->size() > 2 && !locked(learnts[i]) && learnts[i]->activity() < extra_lim)
+    int         i, j;
+    reduceDB_lt lt(ca, core_glue, tier2_glue);
+
+    sort(learnts, lt);
+    int     n_local   = 0;
+    double  extra_lim = 0;
+    while (n_local < learnts.size() && !lt.kept(ca[learnts[n_local]])) n_local++;
+    if (n_local > 0) extra_lim = cla_inc / n_local;  // Remove any local clause below this activity
+
+    for (i = j = 0; i < learnts.size(); i++){
+        Clause& c = ca[learnts[i]];
+        if (i < n_local && !locked(learnts[i]) && (i < n_local / 2 || c.activity() < extra_lim))
             remove(learnts[i]);
-        else
+        else{
+            c.setUsed(false);
             learnts[j++] = learnts[i];
+        }
     }
     learnts.shrink(i - j);
+    n_reduces++;
+    next_reduce = stats.conflicts + reduce_first + (int64)reduce_inc * n_reduces;
+    cleanWatches();
+    checkGarbage();
 }
 
 
@@ -597,7 +716,7 @@ void Solver::reduceDB()
 void Solver::simplifyDB()
 {
     if (!ok) return;    // GUARD (public method)
-    assert(decisionLevel() == 0);
+    cancelUntil(0);
 
     if (propagate() != NULL){
         ok = false;
@@ -615,16 +734,18 @@ void Solver::simplifyDB()
 
     // Remove satisfied clauses:
     for (int type = 0; type < 2; type++){
-        vec<Clause*>& cs = type ? learnts : clauses;
+        vec<CRef>&    cs = type ? learnts : clauses;
         int           j  = 0;
         for (int i = 0; i < cs.size(); i++){
-            if (!locked(cs[i]) && simplify(cs[i]))
+            if (!locked(cs[i]) && simplify(ca[cs[i]]))
                 remove(cs[i]);
             else
                 cs[j++] = cs[i];
         }
         cs.shrink(cs.size()-j);
     }
+    cleanWatches();
+    checkGarbage();
 
     simpDB_assigns = nAssigns();
     simpDB_props   = stats.clauses_literals + stats.learnts_literals;   // (shouldn't depend on 'stats' really, but it will do for now)
@@ -633,19 +754,37 @@ void Solver::simplifyDB()
 
 /*_________________________________________________________________________________________________
 |
-|  search : (nof_conflicts : int) (nof_learnts : int) (params : const SearchParams&)  ->  [lbool]
+|  pickBranchLit : (params : const SearchParams&)  ->  [Lit]
 |  
 |  Description:
-|    Search for a model the specified number of conflicts, keeping the number of learnt clauses
-|    below the provided limit. NOTE! Use negative value for 'nof_conflicts' or 'nof_learnts' to
-|    indicate infinity.
+|    Pick the next decision: the most active unassigned variable (or a random one), assigned its
+|    saved phase if 'params.phase_saving', FALSE otherwise. 'lit_Undef' if all are assigned.
+|________________________________________________________________________________________________@*/
+Lit Solver::pickBranchLit(const SearchParams& params)
+{
+    Var next = order.select(params.random_var_freq);
+    if (next == var_Undef)
+        return lit_Undef;
+    return Lit(next, params.phase_saving ? (bool)polarity[next] : true);
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  search : (nof_conflicts : int) (params : const SearchParams&)  ->  [lbool]
+|  
+|  Description:
+|    Search for a model the specified number of conflicts, reducing the learnt clauses every so
+|    many conflicts (see 'reduceDB()'). NOTE! Use negative value for 'nof_conflicts' to indicate
+|    infinity. With 'restart_Glucose', the search also gives up (restarts) as soon as the recent
+|    learnt clauses get worse than the average.
 |  
 |  Output:
 |    'l_True' if a partial assigment that is consistent with respect to the clauseset is found. If
 |    all variables are decision variables, this means that the clause set is satisfiable. 'l_False'
 |    if the clause set is unsatisfiable. 'l_Undef' if the bound on number of conflicts is reached.
 |________________________________________________________________________________________________@*/
-lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& params)
+lbool Solver::search(int nof_conflicts, const SearchParams& params)
 {
     if (!ok) return l_False;    // GUARD (public method)
     assert(root_level == decisionLevel());
@@ -655,6 +794,7 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
     var_decay = 1 / params.var_decay;
     cla_decay = 1 / params.clause_decay;
     model.clear();
+    glue_queue.clear(); glue_queue_head = 0; glue_queue_sum = 0;
 
     for (;;){
         Clause* confl = propagate();
@@ -669,6 +809,17 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 analyzeFinal(confl);
                 return l_False; }
             analyze(confl, learnt_clause, backtrack_level);
+            if (params.restart == restart_Glucose){
+                int glue = computeLBD(learnt_clause);
+                glue_sum += glue; glue_count++;
+                if (glue_queue.size() < glue_queue_size)
+                    glue_queue.push(glue);
+                else{
+                    glue_queue_sum -= glue_queue[glue_queue_head];
+                    glue_queue[glue_queue_head] = glue;
+                    glue_queue_head = (glue_queue_head + 1) % glue_queue_size; }
+                glue_queue_sum += glue;
+            }
             cancelUntil(max(backtrack_level, root_level));
             newClause(learnt_clause, true, (proof != NULL) ? proof->last() : ClauseId_NULL);
             if (learnt_clause.size() == 1) level[var(learnt_clause[0])] = 0;    // (this is ugly (but needed for 'analyzeFinal()') -- in future versions, we will backtrack past the 'root_level' and redo the assumptions)
@@ -678,8 +829,10 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
         }else{
             // NO CONFLICT
 
-            if (nof_conflicts >= 0 && conflictC >= nof_conflicts){
-                // Reached bound on number of conflicts:
+            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()
+            ||  (glue_queue.size() == glue_queue_size
+                 && glue_queue_sum * glue_restart_k * glue_count > (double)glue_sum * glue_queue_size)){
+                // Reached bound on number of conflicts (or on the budget of this call, or the recent glue):
                 progress_estimate = progressEstimate();
                 cancelUntil(root_level);
                 return l_Undef; }
@@ -688,15 +841,15 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 // Simplify the set of problem clauses:
                 simplifyDB(), assert(ok);
 
-            if (nof_learnts >= 0 && learnts.size()-nAssigns() >= nof_learnts)
+            if (stats.conflicts >= next_reduce)
                 // Reduce the set of learnt clauses:
                 reduceDB();
 
             // New variable decision:
             stats.decisions++;
-            Var next = order.select(params.random_var_freq);
+            Lit next = pickBranchLit(params);
 
-            if (next == var_Undef){
+            if (next == lit_Undef){
                 // Model found:
                 model.growTo(nVars());
                 for (int i = 0; i < nVars(); i++) model[i] = value(i);
@@ -704,7 +857,7 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 return l_True;
             }
 
-            check(assume(~Lit(next)));
+            check(assume(next));
         }
     }
 }
@@ -738,42 +891,79 @@ void Solver::varRescaleActivity()
 void Solver::claRescaleActivity()
 {
     for (int i = 0; i < learnts.size(); i++)
-        learnts[i]->activity() *= 1e-20;
+        ca[learnts[i]].activity() *= 1e-20;
     cla_inc *= 1e-20;
 }
 
 
+// Finite subsequences of the Luby-sequence:
+//
+//   0: 1
+//   1: 1 1 2
+//   2: 1 1 2 1 1 2 4
+//   3: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8
+//   ...
+//
+static double luby(double y, int x)
+{
+    // Find the finite subsequence that contains index 'x', and the size of that subsequence:
+    int size, seq;
+    for (size = 1, seq = 0; size < x+1; seq++, size = 2*size+1);
+
+    while (size-1 != x){
+        size = (size-1)>>1;
+        seq--;
+        x = x % size;
+    }
+    return pow(y, seq);
+}
+
+
 /*_________________________________________________________________________________________________
 |
-|  solve : (assumps : const vec<Lit>&)  ->  [bool]
+|  solveLimited : (assumps : const vec<Lit>&)  ->  [lbool]
 |  
 |  Description:
-|    Top-level solve. If using assumptions (non-empty 'assumps' vector), you must call
+|    Top-level solve; 'l_Undef' means the budget set by 'setConfBudget()'/'setPropBudget()' ran
+|    out before an answer was found ('solve()' calls this without a budget). If using assumptions (non-empty 'assumps' vector), you must call
 |    'simplifyDB()' first to see that no top-level conflict is present (which would put the solver
 |    in an undefined state).
 |  
+|    The levels of the assumptions are kept when the call returns. The next call starts from the
+|    longest prefix of its assumptions that is still assigned the same way, and only simplifies
+|    the clause database if it gets back to level 0. Adding a problem clause drops them all.
+|  
 |  Input:
 |    A list of assumptions (unit clauses coded as literals). Pre-condition: The assumptions must
 |    not contain both 'x' and '~x' for any variable 'x'.
 |________________________________________________________________________________________________@*/
-bool Solver::solve(const vec<Lit>& assumps)
+lbool Solver::solveLimited(const vec<Lit>& assumps)
 {
-    simplifyDB();
-    if (!ok) return false;
+    if (!ok) return l_False;
+
+    // Keep the levels of the assumptions shared with the last call:
+    int     shared = 0;
+    while (shared < assumps.size() && shared < assumed.size() && assumed[shared] == assumps[shared])
+        shared++;
+    cancelUntil(shared);
+    if (decisionLevel() == 0){
+        simplifyDB();
+        if (!ok) return l_False; }
 
     SearchParams    params(default_params);
-    double  nof_conflicts = 100;
-    double  nof_learnts   = nClauses() / 3;
+    double  nof_conflicts = restart_unit;
+    int     n_restarts    = 0;
     lbool   status        = l_Undef;
 
     // Perform assumptions:
     root_level = assumps.size();
-    for (int i = 0; i < assumps.size(); i++){
+    for (int i = decisionLevel(); i < assumps.size(); i++){
         Lit p = assumps[i];
         assert(var(p) < nVars());
+        assumed.push(p);
         if (!assume(p)){
-            if (reason[var(p)] != NULL){
-                analyzeFinal(reason[var(p)], true);
+            if (reason[var(p)] != GClause_NULL){
+                analyzeFinal(reasonOf(var(p), propagate_tmpbin), true);
                 conflict.push(~p);
             }else{
                 assert(proof == NULL || unit_id[var(p)] != ClauseId_NULL);   // (this is the pre-condition above)
@@ -781,13 +971,13 @@ bool Solver::solve(const vec<Lit>& assumps)
                 conflict.push(~p);
                 if (proof != NULL) conflict_id = unit_id[var(p)];
             }
-            cancelUntil(0);
-            return false; }
+            cancelUntil(i);
+            return l_False; }
         Clause* confl = propagate();
         if (confl != NULL){
             analyzeFinal(confl), assert(conflict.size() > 0);
-            cancelUntil(0);
-            return false; }
+            cancelUntil(i);     // (the conflict involves 'p'; the levels below are consistent)
+            return l_False; }
     }
     assert(root_level == decisionLevel());
 
@@ -803,25 +993,29 @@ bool Solver::solve(const vec<Lit>& assumps)
         reportf("===================================\n");
     }
 
-    while (status == l_Undef){
+    while (status == l_Undef && withinBudget()){
         if (verbosity >= 1){
             printStats();
             reportf("| %9d | %7d %8d | %7d %7d %8d %7.1f | %6.3f %% |\n",
                    (int)stats.conflicts, nClauses(),
                    (int)stats.clauses_literals,
-                   (int)nof_learnts, nLearnts(),
+                   (int)next_reduce, nLearnts(),
                    (int)stats.learnts_literals,
                    (double)stats.learnts_literals/nLearnts(),
                    progress_estimate*100);
             fflush(stdout);
         }
-        status = search((int)nof_conflicts, (int)nof_learnts, params);
+        if (params.restart == restart_Luby)
+            nof_conflicts = luby(2, n_restarts) * restart_unit;
+        else if (params.restart == restart_Glucose)
+            nof_conflicts = -1;
+        status = search((int)nof_conflicts, params);
         nof_conflicts *= 1.5;
-        nof_learnts   *= 1.1;
+        n_restarts++;
 
 if ((int)stats.conflicts >= effLimit) {
    cancelUntil(0);
-   return status == l_True;
+   return status == l_True? l_True : l_False;
 }
     }
     if (verbosity >= 1) {
@@ -829,8 +1023,9 @@ if ((int)stats.conflicts >= effLimit) {
         reportf("===================================\n");
     }
 
-    cancelUntil(0);
-    return status == l_True;
+    if (status == l_False)
+        cancelUntil(max(root_level - 1, 0));   // (the conflict is on the last level of the assumptions)
+    return status;
 }
 
 void Solver::printStats()
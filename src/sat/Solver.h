@@ -40,9 +40,17 @@ struct SolverStats {
 };
 
 
+// restart_Geometric: 100 conflicts, 1.5 times more after each restart.
+// restart_Luby     : 100 conflicts times the Luby sequence (1 1 2 1 1 2 4 ...).
+// restart_Glucose  : whenever the glue of the recent learnt clauses is well above the average.
+enum RestartPolicy { restart_Geometric, restart_Luby, restart_Glucose };
+
 struct SearchParams {
-    double  var_decay, clause_decay, random_var_freq;    // (reasonable values are: 0.95, 0.999, 0.02)    
-    SearchParams(double v = 1, double c = 1, double r = 0) : var_decay(v), clause_decay(c), random_var_freq(r) { }
+    double          var_decay, clause_decay, random_var_freq;    // (reasonable values are: 0.95, 0.999, 0.02)    
+    RestartPolicy   restart;
+    bool            phase_saving;       // Decide on the last value of a variable rather than always on FALSE.
+    SearchParams(double v = 1, double c = 1, double r = 0, RestartPolicy rs = restart_Geometric, bool ps = false)
+        : var_decay(v), clause_decay(c), random_var_freq(r), restart(rs), phase_saving(ps) { }
 };
 
 
@@ -51,8 +59,10 @@ protected:
     // Solver state:
     //
     bool                ok;               // If FALSE, the constraints are already unsatisfiable. No part of the solver state may be used!
-    vec<Clause*>        clauses;          // List of problem clauses.
-    vec<Clause*>        learnts;          // List of learnt clauses.
+    ClauseAllocator     ca;               // The clauses themselves (all but the inlined binary ones).
+    vec<CRef>           clauses;          // List of problem clauses.
+    vec<CRef>           learnts;          // List of learnt clauses.
+    int                 n_bin_clauses;    // Number of binary problem clauses kept only in the watcher lists.
     vec<ClauseId>       unit_id;          // 'unit_id[var]' is the clause ID for the unit literal 'var' or '~var' (if set at toplevel).
     double              cla_inc;          // Amount to bump next clause with.
     double              cla_decay;        // INVERSE decay factor for clause activity: stores 1/decay.
@@ -60,19 +70,33 @@ protected:
     vec<double>         activity;         // A heuristic measurement of the activity of a variable.
     double              var_inc;          // Amount to bump next variable with.
     double              var_decay;        // INVERSE decay factor for variable activity: stores 1/decay. Use negative value for static variable order.
+    vec<char>           decision;         // 'decision[var]' is TRUE if 'var' may be decided on (see 'setDecisionVar()').
     VarOrder            order;            // Keeps track of the decision variable order.
 
-    vec<vec<Clause*> >  watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    vec<vec<Watcher> >  watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    vec<char>           watch_dirty;      // 'watch_dirty[lit]' is TRUE if 'watches[lit]' may hold removed clauses (see 'cleanWatches()').
+    vec<Lit>            watch_dirties;    // The literals with 'watch_dirty' set.
     vec<char>           assigns;          // The current assignments (lbool:s stored as char:s).
     vec<Lit>            trail;            // Assignment stack; stores all assigments made in the order they were made.
     vec<int>            trail_lim;        // Separator indices for different decision levels in 'trail[]'.
-    vec<Clause*>        reason;           // 'reason[var]' is the clause that implied the variables current value, or 'NULL' if none.
+    vec<char>           polarity;         // 'polarity[var]' is the last value assigned to 'var' (as 'sign()': TRUE means FALSE), for phase saving.
+    vec<GClause>        reason;           // 'reason[var]' is the clause that implied the variables current value, or 'GClause_NULL' if none. For an inlined binary clause, the other (false) literal.
     vec<int>            level;            // 'level[var]' is the decision level at which assignment was made.
     vec<int>            trail_pos;        // 'trail_pos[var]' is the variable's position in 'trail[]'. This supersedes 'level[]' in some sense, and 'level[]' will probably be removed in future releases.
     int                 root_level;       // Level of first proper decision.
+    vec<Lit>            assumed;          // 'assumed[i]' is the assumption made at level 'i+1' (kept across calls to 'solve()').
     int                 qhead;            // Head of queue (as index into the trail -- no more explicit propagation queue in MiniSat).
     int                 simpDB_assigns;   // Number of top-level assignments since last execution of 'simplifyDB()'.
     int64               simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplifyDB()'.
+    int64               next_reduce;      // Value of 'stats.conflicts' at which 'reduceDB()' is due (kept across calls to 'solve()').
+    int                 n_reduces;        // Number of executions of 'reduceDB()'.
+    vec<uint>           lbd_stamp;        // 'lbd_stamp[level]' is 'lbd_counter' if 'level' was counted by the current 'computeLBD()'.
+    uint                lbd_counter;
+    vec<int>            glue_queue;       // Glue of the last learnt clauses, 'glue_queue_size' at most (restart_Glucose only).
+    int                 glue_queue_head;
+    int64               glue_queue_sum;
+    int64               glue_sum;         // Glue of all learnt clauses so far (restart_Glucose only).
+    int64               glue_count;
 
     // Temporaries (to reduce allocation overhead). Each variable is prefixed by the method in which is used:
     //
@@ -94,11 +118,11 @@ protected:
     void        analyze          (Clause* confl, vec<Lit>& out_learnt, int& out_btlevel); // (bt = backtrack)
     bool        analyze_removable(Lit p, uint min_level);                                 // (helper method for 'analyze()')
     void        analyzeFinal     (Clause* confl, bool skip_first = false);
-    bool        enqueue          (Lit fact, Clause* from = NULL);
+    bool        enqueue          (Lit fact, GClause from = GClause_NULL);
     Clause*     propagate        ();
     void        reduceDB         ();
     Lit         pickBranchLit    (const SearchParams& params);
-    lbool       search           (int nof_conflicts, int nof_learnts, const SearchParams& params);
+    lbool       search           (int nof_conflicts, const SearchParams& params);
     double      progressEstimate ();
 
     // Activity:
@@ -116,28 +140,65 @@ protected:
     //
     void     newClause(const vec<Lit>& ps, bool learnt = false, ClauseId id = ClauseId_NULL, bool A = true);
     void     claBumpActivity (Clause* c) { if ( (c->activity() += cla_inc) > 1e20 ) claRescaleActivity(); }
-    void     remove          (Clause* c, bool just_dealloc = false);
-    bool     locked          (const Clause* c) const { return reason[var((*c)[0])] == c; }
-    bool     simplify        (Clause* c) const;
+    void     remove          (CRef cr);
+    bool     locked          (CRef cr) { return reason[var(ca[cr][0])] == GClause_new(cr); }
+    Clause*  reasonOf        (Var x, Clause* tmp) {     // (a binary reason is spelled out in 'tmp'; NULL if no reason)
+        GClause r = reason[x];
+        if (!r.isLit()) return (r == GClause_NULL) ? NULL : ca.lea(r.clause());
+        (*tmp)[0] = Lit(x, value(x) == l_False); (*tmp)[1] = r.lit(); return tmp; }
+    bool     simplify        (const Clause& c) const;
+    template<class C>
+    int      computeLBD      (const C& c) {             // (number of distinct decision levels in 'c')
+        if (++lbd_counter == 0){ for (int i = 0; i < lbd_stamp.size(); i++) lbd_stamp[i] = 0; lbd_counter = 1; }
+        int n = 0;
+        for (int i = 0; i < c.size(); i++){
+            int l = level[var(c[i])];
+            if (lbd_stamp[l] != lbd_counter){ lbd_stamp[l] = lbd_counter; n++; } }
+        return n; }
+
+    // Memory management of the clauses:
+    //
+    void     cleanWatches    ();
+    void     checkGarbage    () { if (ca.wasted() > ca.size() * garbage_frac) garbageCollect(); }
+    void     garbageCollect  ();
+    void     relocAll        (ClauseAllocator& to);
 
     int      decisionLevel() const { return trail_lim.size(); }
 
 public:
     Solver() : ok               (true)
+             , n_bin_clauses    (0)
              , cla_inc          (1)
              , cla_decay        (1)
              , var_inc          (1)
              , var_decay        (1)
-             , order            (assigns, activity)
+             , order            (assigns, decision, activity)
              , qhead            (0)
              , simpDB_assigns   (0)
              , simpDB_props     (0)
+             , next_reduce      (0)
+             , n_reduces        (0)
+             , lbd_counter      (0)
+             , glue_queue_head  (0)
+             , glue_queue_sum   (0)
+             , glue_sum         (0)
+             , glue_count       (0)
              , default_params   (SearchParams(0.95, 0.999, 0.02))
              , expensive_ccmin  (2)
+             , garbage_frac     (0.20)
+             , core_glue        (2)
+             , tier2_glue       (6)
+             , reduce_first     (2000)
+             , reduce_inc       (300)
+             , restart_unit     (100)
+             , glue_queue_size  (50)
+             , glue_restart_k   (0.8)
              , proof            (NULL)
              , verbosity        (0)
              , progress_estimate(0)
              , conflict_id      (ClauseId_NULL)
+             , conflict_budget  (-1)
+             , propagation_budget(-1)
              {
                 vec<Lit> dummy(2,lit_Undef);
                 propagate_tmpbin = Clause_new(false, dummy);
@@ -145,13 +206,13 @@ public:
                 addUnit_tmp   .growTo(1);
                 addBinary_tmp .growTo(2);
                 addTernary_tmp.growTo(3);
+                lbd_stamp     .growTo(1, 0);
+                next_reduce = reduce_first;
              }
 
    ~Solver() {
-       for (int i = 0; i < learnts.size(); i++) remove(learnts[i], true);
-       for (int i = 0; i < clauses.size(); i++) if (clauses[i] != NULL) remove(clauses[i], true);
-       remove(propagate_tmpbin, true);
-       remove(analyze_tmpbin, true);
+       xfree(propagate_tmpbin);         // (the other clauses go with 'ca')
+       xfree(analyze_tmpbin);
     }
 
     // Helpers: (semi-internal)
@@ -162,7 +223,7 @@ public:
 //    lbool   modelValue(Lit p) const { return model[var(p)] ^ sign(p); }
 
     int     nAssigns() { return trail.size(); }
-    int     nClauses() { return clauses.size(); }
+    int     nClauses() { return clauses.size() + n_bin_clauses; }
     int     nLearnts() { return learnts.size(); }
 
     // Statistics: (read-only member variable)
@@ -173,6 +234,14 @@ public:
     //
     SearchParams    default_params;     // Restart frequency etc.
     int             expensive_ccmin;    // Controls conflict clause minimization. TRUE by default.
+    double          garbage_frac;       // Compact the clause region once this fraction of it is wasted.
+    int             core_glue;          // Learnt clauses of at most this glue (LBD) are never removed.
+    int             tier2_glue;         // Up to this glue, a learnt clause is kept as long as it takes part in conflicts.
+    int             reduce_first;       // 'reduceDB()' after this many conflicts, then 'reduce_inc' more each time.
+    int             reduce_inc;
+    int             restart_unit;       // Conflicts before the first restart (restart_Geometric, restart_Luby).
+    int             glue_queue_size;    // restart_Glucose: restart once the average glue of the last 'glue_queue_size'
+    double          glue_restart_k;     // learnt clauses, times 'glue_restart_k', exceeds the overall average.
     Proof*          proof;              // Set this directly after constructing 'Solver' to enable proof logging. Initialized to NULL.
     int             verbosity;          // Verbosity level. 0=silent, 1=some progress report, 2=everything
 
@@ -185,18 +254,32 @@ public:
     void    addTernary(Lit p, Lit q, Lit r) { addTernary_tmp[0] = p; addTernary_tmp[1] = q; addTernary_tmp[2] = r; addClause(addTernary_tmp); }
     void    addClause (const vec<Lit>& ps , bool A = true)  { newClause(ps , false , ClauseId_NULL , A); }  
 	 // (used to be a difference between internal and external method...)
+    void    setDecisionVar(Var x, bool b)   { decision[x] = b; if (b) order.undo(x); }   // (all variables are decision variables by default)
 
     // Solving:
     //
     bool    okay() { return ok; }       // FALSE means solver is in an conflicting state (must never be used again!)
     void    simplifyDB();
-    bool    solve(const vec<Lit>& assumps);
+    bool    solve(const vec<Lit>& assumps) { budgetOff(); return solveLimited(assumps) == l_True; }
     bool    solve() { vec<Lit> tmp; return solve(tmp); }
 
+    // Resource limits, counted from the call that sets them. 'solveLimited()' returns 'l_Undef'
+    // once one of them is used up; 'solve()' turns them off.
+    //
+    lbool   solveLimited(const vec<Lit>& assumps);
+    void    setConfBudget(int64 x) { conflict_budget    = stats.conflicts    + x; }
+    void    setPropBudget(int64 x) { propagation_budget = stats.propagations + x; }
+    void    budgetOff()            { conflict_budget = propagation_budget = -1; }
+    bool    withinBudget() const {
+        return (conflict_budget    < 0 || stats.conflicts    < conflict_budget)
+            && (propagation_budget < 0 || stats.propagations < propagation_budget); }
+
     double      progress_estimate;  // Set by 'search()'.
     vec<lbool>  model;              // If problem is satisfiable, this vector contains the model (if any).
     vec<Lit>    conflict;           // If problem is unsatisfiable under assumptions, this vector represent the conflict clause expressed in the assumptions.
     ClauseId    conflict_id;        // (In proof logging mode only.) ID for the clause 'conflict' (for proof traverseral). NOTE! The empty clause is always the last clause derived, but for conflicts under assumption, this is not necessarly true.
+    int64       conflict_budget;    // -1 means no limit (see 'setConfBudget()').
+    int64       propagation_budget; // -1 means no limit (see 'setPropBudget()').
 
     // Printing:
     //
@@ -72,6 +72,7 @@ const Lit lit_Error(var_Undef, true );  // }
 inline int toDimacs(Lit p) { return sign(p) ? -var(p) - 1 : var(p) + 1; }
 
 
+//=================================================================================================
 //=================================================================================================
 // Clause -- a simple class for representing a clause:
 
@@ -82,59 +83,174 @@ const   int ClauseId_NULL = INT_MIN;
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 class Clause {
-    uint    size_learnt;
+    struct {
+        unsigned learnt  : 1;
+        unsigned has_id  : 1;
+        unsigned deleted : 1;     // (removed; memory is reclaimed by the next garbage collection)
+        unsigned reloced : 1;     // (moved by the garbage collector; 'data[0]' is the new reference)
+        unsigned used    : 1;     // (learnt: took part in a conflict since the last 'reduceDB()')
+        unsigned glue    : 5;     // (learnt: literal block distance when learnt or last used, at most 31)
+        unsigned size    : 22;
+    }       header;
     Lit     data[1];
 public:
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
     Clause(bool learnt, const vec<Lit>& ps, ClauseId id_ = ClauseId_NULL) {
-        size_learnt = (ps.size() << 1) | (int)learnt;
+        header.learnt  = learnt;
+        header.has_id  = (id_ != ClauseId_NULL);
+        header.deleted = 0;
+        header.reloced = 0;
+        header.used    = 0;
+        header.glue    = 0;
+        header.size    = ps.size();
+        assert(ps.size() < (1 << 22));
         for (int i = 0; i < ps.size(); i++) data[i] = ps[i];
         if (learnt) activity() = 0;
         if (id_ != ClauseId_NULL) id() = id_; }
 
-    // -- use this function instead:
+    // -- use this function instead (or 'ClauseAllocator::alloc()'):
     friend Clause* Clause_new(bool, const vec<Lit>&, ClauseId);
 
-    int       size        ()      const { return size_learnt >> 1; }
-    bool      learnt      ()      const { return size_learnt & 1; }
+    int       size        ()      const { return header.size; }
+    bool      learnt      ()      const { return header.learnt; }
     Lit       operator [] (int i) const { return data[i]; }
     Lit&      operator [] (int i)       { return data[i]; }
     float&    activity    ()      const {
         void *p = const_cast<Lit*>(&data[size()]); return *((float *)p);
     } //              return *((float*)&data[size()]); }
     ClauseId& id          ()      const { return *((ClauseId*)&data[size() + (int)learnt()]); }
+    int       glue        ()      const { return header.glue; }
+    void      setGlue     (int g)       { header.glue = (g < 31) ? g : 31; }
+    bool      used        ()      const { return header.used; }
+    void      setUsed     (bool u)      { header.used = u; }
+
+    // Memory management (see 'ClauseAllocator'):
+    static int words      (int size, bool learnt, bool has_id) { return 1 + size + (int)learnt + (int)has_id; }
+    int       words       ()      const { return words(size(), learnt(), header.has_id); }
+    bool      deleted     ()      const { return header.deleted; }
+    void      setDeleted  ()            { header.deleted = 1; }
+    bool      reloced     ()      const { return header.reloced; }
+    uint      relocation  ()      const { return *((uint*)&data[0]); }
+    void      relocate    (uint r)      { header.reloced = 1; *((uint*)&data[0]) = r; }
 };
 
 inline Clause* Clause_new(bool learnt, const vec<Lit>& ps, ClauseId id = ClauseId_NULL) {
     assert(sizeof(Lit)      == sizeof(uint));
     assert(sizeof(float)    == sizeof(uint));
     assert(sizeof(ClauseId) == sizeof(uint));
-    void*   mem = xmalloc<char>(sizeof(Clause) + sizeof(uint)*(ps.size() + (int)learnt + (int)(id != ClauseId_NULL)));
+    void*   mem = xmalloc<char>(sizeof(uint) * Clause::words(ps.size(), learnt, id != ClauseId_NULL));
     return new (mem) Clause(learnt, ps, id); }
 
 
+//=================================================================================================
+// ClauseAllocator -- the clauses of a solver, in one region:
+
+
+// Clauses are addressed by 32-bit offsets ('CRef', in words) into one growing array. Freed clauses
+// are only counted; 'reloc()'-ing every live reference into a fresh allocator compacts the region.
+// NOTE! 'Clause*'/'Clause&' obtained from a 'CRef' are invalidated by the next 'alloc()'.
+
+typedef uint CRef;
+const   CRef CRef_Undef = 0x7fffffff;   // (31 bits, so that a 'GClause' can tag it)
+
+class ClauseAllocator {
+    uint*   memory;
+    uint    sz;
+    uint    cap;
+    uint    wasted_;
+
+    void    grow(uint min_cap) {
+        if (min_cap <= cap) return;
+        uint prev = cap;
+        while (cap < min_cap){
+            uint delta = ((cap >> 1) + (cap >> 3) + 2) & ~1;   // (grow by about 5/8)
+            cap += delta;
+            if (cap <= prev || cap >= CRef_Undef){ fprintf(stderr, "ERROR! Clause region is full.\n"); exit(1); }
+        }
+        memory = xrealloc(memory, cap); }
+
+public:
+    ClauseAllocator(uint start_cap = 0) : memory(NULL), sz(0), cap(0), wasted_(0) { grow(start_cap); }
+   ~ClauseAllocator() { if (memory != NULL) xfree(memory); }
+
+    uint    size    () const { return sz; }
+    uint    wasted  () const { return wasted_; }
+
+    CRef    alloc(bool learnt, const vec<Lit>& ps, ClauseId id = ClauseId_NULL) {
+        assert(sizeof(Lit) == sizeof(uint));
+        uint w = Clause::words(ps.size(), learnt, id != ClauseId_NULL);
+        grow(sz + w);
+        CRef r = sz; sz += w;
+        new (&memory[r]) Clause(learnt, ps, id);
+        return r; }
+    CRef    alloc(const Clause& from) {         // (verbatim copy, for the garbage collector)
+        uint w = from.words();
+        grow(sz + w);
+        CRef r = sz; sz += w;
+        memcpy(&memory[r], &from, sizeof(uint) * w);
+        return r; }
+    void    free (CRef r) { wasted_ += (*this)[r].words(); }
+
+    Clause&       operator [] (CRef r)       { return *(Clause*)&memory[r]; }
+    const Clause& operator [] (CRef r) const { return *(const Clause*)&memory[r]; }
+    Clause*       lea         (CRef r)       { return (Clause*)&memory[r]; }
+    CRef          ael         (const Clause* c) const { return (CRef)((const uint*)c - memory); }
+
+    // Move (the clause of) 'r' into 'to', once; update 'r' to the new reference.
+    void    reloc(CRef& r, ClauseAllocator& to) {
+        Clause& c = (*this)[r];
+        if (!c.reloced()){
+            CRef n = to.alloc(c);
+            c.relocate(n); }
+        r = c.relocation(); }
+
+    void    moveTo(ClauseAllocator& to) {
+        if (to.memory != NULL) xfree(to.memory);
+        to.memory = memory; to.sz = sz; to.cap = cap; to.wasted_ = wasted_;
+        memory = NULL; sz = cap = wasted_ = 0; }
+};
+
+
 //=================================================================================================
 // GClause -- Generalize clause:
 
 
-// Either a pointer to a clause or a literal.
+// Either a reference to a clause or a literal.
 class GClause {
-    void*   data;
-    GClause(void* d) : data(d) {}
+    uint    data;
+    GClause(uint d) : data(d) {}
 public:
+    GClause() : data(CRef_Undef << 1) {}
     friend GClause GClause_new(Lit p);
-    friend GClause GClause_new(Clause* c);
+    friend GClause GClause_new(CRef c);
 
-    bool        isLit    () const { return ((uintp)data & 1) == 1; }
-    Lit         lit      () const { return toLit(((intp)data) >> 1); }
-    Clause*     clause   () const { return (Clause*)data; }
+    bool        isLit    () const { return (data & 1) == 1; }
+    Lit         lit      () const { return toLit(data >> 1); }
+    CRef        clause   () const { return data >> 1; }
     bool        operator == (GClause c) const { return data == c.data; }
     bool        operator != (GClause c) const { return data != c.data; }
 };
-inline GClause GClause_new(Lit p)     { return GClause((void*)(((intp)index(p) << 1) + 1)); }
-inline GClause GClause_new(Clause* c) { assert(((uintp)c & 1) == 0); return GClause((void*)c); }
+inline GClause GClause_new(Lit p)  { return GClause(((uint)index(p) << 1) + 1); }
+inline GClause GClause_new(CRef c) { assert(c <= CRef_Undef); return GClause(c << 1); }
 
-#define GClause_NULL GClause_new((Clause*)NULL)
+#define GClause_NULL GClause_new(CRef_Undef)
+
+
+//=================================================================================================
+// Watcher -- an entry of a watch list:
+
+
+// The clause, plus one of its other literals (the "blocker"). If the blocker is true, the clause is
+// satisfied and propagation can skip it without touching the clause itself. A binary clause has no
+// 'Clause' at all (unless logging a proof): 'cref' is 'CRef_Undef' and the blocker is the other
+// literal.
+struct Watcher {
+    CRef    cref;
+    Lit     blocker;
+    Watcher() : cref(CRef_Undef) {}
+    Watcher(CRef c, Lit p) : cref(c), blocker(p) {}
+    bool binary() const { return cref == CRef_Undef; }
+};
 
 
 //=================================================================================================
@@ -35,14 +35,15 @@ struct VarOrder_lt {
 
 class VarOrder {
     const vec<char>&    assigns;     // var->val. Pointer to external assignment table.
+    const vec<char>&    decision;    // var->bool. Pointer to external table of the variables that may be decided on.
 //    const vec<double>&  activity;    // var->act. Pointer to external activity table.
     Heap<VarOrder_lt>   heap;
     double              random_seed; // For the internal random number generator
 
 public:
-    VarOrder(const vec<char>& ass, const vec<double>& act) :
+    VarOrder(const vec<char>& ass, const vec<char>& dec, const vec<double>& act) :
 //        assigns(ass), activity(act), heap(VarOrder_lt(act)), random_seed(91648253)
-        assigns(ass), heap(VarOrder_lt(act)), random_seed(91648253)
+        assigns(ass), decision(dec), heap(VarOrder_lt(act)), random_seed(91648253)
         { }
 
     inline void newVar(void);
@@ -68,7 +69,7 @@ void VarOrder::update(Var x)
 
 void VarOrder::undo(Var x)
 {
-    if (!heap.inHeap(x))
+    if (!heap.inHeap(x) && decision[x])
         heap.insert(x);
 }
 
@@ -78,14 +79,14 @@ Var VarOrder::select(double random_var_freq)
     // Random decision:
     if (drand(random_seed) < random_var_freq && !heap.empty()){
         Var next = irand(random_seed,assigns.size());
-        if (toLbool(assigns[next]) == l_Undef)
+        if (toLbool(assigns[next]) == l_Undef && decision[next])
             return next;
     }
 
     // Activity based decision:
     while (!heap.empty()){
         Var next = heap.getmin();
-        if (toLbool(assigns[next]) == l_Undef)
+        if (toLbool(assigns[next]) == l_Undef && decision[next])
             return next;
     }
 
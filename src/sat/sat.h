@@ -11,16 +11,65 @@
 
 #include <cassert>
 #include <iostream>
-#include "Solver.h"
+#include <vector>
+#include "SimpSolver.h"
 
 using namespace std;
 
+/********** SAT call statistics **********/
+// Of a single SAT call, or summed up over several; see
+// SatSolver::getStats(). _peakMem is the largest one seen.
+struct SatStats
+{
+   SatStats(): _calls(0), _conflicts(0), _decisions(0), _propagations(0),
+               _restarts(0), _learntLits(0), _time(0), _peakMem(0) {}
+
+   void add(const SatStats& s) {
+      _calls += s._calls; _conflicts += s._conflicts;
+      _decisions += s._decisions; _propagations += s._propagations;
+      _restarts += s._restarts; _learntLits += s._learntLits;
+      _time += s._time;
+      if (s._peakMem > _peakMem) _peakMem = s._peakMem;
+   }
+   // Average size of the learnt clauses
+   double learntSize() const {
+      return _conflicts? (double)_learntLits / _conflicts : 0;
+   }
+
+   // Machine-readable dumps: a JSON object, or CSV columns (no line end)
+   void writeJson(ostream& os) const {
+      os << "{\"calls\": " << _calls << ", \"conflicts\": " << _conflicts
+         << ", \"decisions\": " << _decisions << ", \"propagations\": "
+         << _propagations << ", \"restarts\": " << _restarts
+         << ", \"learnt_lits\": " << _learntLits << ", \"time\": " << _time
+         << ", \"peak_mem_mb\": " << _peakMem << "}";
+   }
+   static void writeCsvHeader(ostream& os) {
+      os << "calls,conflicts,decisions,propagations,restarts,learnt_lits,"
+         << "time,peak_mem_mb";
+   }
+   void writeCsv(ostream& os) const {
+      os << _calls << ',' << _conflicts << ',' << _decisions << ','
+         << _propagations << ',' << _restarts << ',' << _learntLits << ','
+         << _time << ',' << _peakMem;
+   }
+
+   size_t   _calls;
+   int64    _conflicts;
+   int64    _decisions;
+   int64    _propagations;
+   int64    _restarts;     // not counting the start of each call
+   int64    _learntLits;   // in the learnt clauses, after minimization
+   double   _time;         // seconds, wall clock
+   double   _peakMem;      // MB; peak resident size of the whole process
+};
+
 /********** MiniSAT_Solver **********/
 class SatSolver
 {
    public : 
-      SatSolver():_solver(0) { }
-      ~SatSolver() { }
+      SatSolver():_solver(0), _startTime(0) { }
+      ~SatSolver() { if (_solver) delete _solver; }
 
       // Solver initialization and reset
       void initialize() {
@@ -29,10 +78,23 @@ class SatSolver
       }
       void reset() {
          if (_solver) delete _solver;
-         _solver = new Solver();
+         _solver = new SimpSolver();
          _assump.clear(); _curVar = 0;
+         _stats = _lastCall = SatStats();
       }
 
+      // CNF preprocessing. A frozen Var is kept; the others may be
+      // eliminated by preprocess() and must not be used again. Return false
+      // if the clauses are found UNSAT.
+      void setFrozen(Var v, bool b) { _solver->setFrozen(v, b); }
+      bool isEliminated(Var v) const { return _solver->isEliminated(v); }
+      bool preprocess() { return _solver->eliminate(); }
+      int nClauses() const { return _solver->nClauses(); }
+
+      // Search heuristics; reset by initialize()
+      void setRestart(RestartPolicy r) { _solver->default_params.restart = r; }
+      void setPhaseSaving(bool b) { _solver->default_params.phase_saving = b; }
+
       // Constructing proof model
       // Return the Var ID of the new Var
       inline Var newVar() { _solver->newVar(); return _curVar++; }
@@ -64,31 +126,116 @@ class SatSolver
          lits.push(~la); lits.push(~lb); lits.push(~lf);
          _solver->addClause(lits); lits.clear();
       }
+      // va (fa) != vb (fb) whenever "act" is true. Assume "act" to check
+      // the pair; afterwards retire it with assertProperty(act, false) so
+      // that both clauses (and what was learnt from them) get dropped.
+      void addMiterCNF(Var act, Var va, bool fa, Var vb, bool fb) {
+         vec<Lit> lits;
+         Lit lg = Lit(act);
+         Lit la = fa? ~Lit(va): Lit(va);
+         Lit lb = fb? ~Lit(vb): Lit(vb);
+         lits.push(~lg); lits.push( la); lits.push( lb);
+         _solver->addClause(lits); lits.clear();
+         lits.push(~lg); lits.push(~la); lits.push(~lb);
+         _solver->addClause(lits); lits.clear();
+      }
+      // "act" implies one of "vs"; e.g. one of several miters is active
+      void addOrCNF(Var act, const vector<Var>& vs) {
+         vec<Lit> lits;
+         lits.push(~Lit(act));
+         for (size_t i = 0; i < vs.size(); ++i) lits.push(Lit(vs[i]));
+         _solver->addClause(lits);
+      }
+      // va (fa) == vb (fb); for pairs already proven equivalent
+      void addEqCNF(Var va, bool fa, Var vb, bool fb) {
+         vec<Lit> lits;
+         Lit la = fa? ~Lit(va): Lit(va);
+         Lit lb = fb? ~Lit(vb): Lit(vb);
+         lits.push(~la); lits.push( lb);
+         _solver->addClause(lits); lits.clear();
+         lits.push( la); lits.push(~lb);
+         _solver->addClause(lits); lits.clear();
+      }
 
       // For incremental proof, use "assumeSolve()"
       void assumeRelease() { _assump.clear(); }
       void assumeProperty(Var prop, bool val) {
          _assump.push(val? Lit(prop): ~Lit(prop));
       }
-      bool assumpSolve() { return _solver->solve(_assump); }
+      bool assumpSolve() {
+         startCall();
+         bool r = _solver->solve(_assump);
+         endCall();
+         return r;
+      }
+      // Same, but give up after "conflicts"/"propagations" (0: no limit)
+      // Return 1/0/-1 for SAT/UNSAT/undecided
+      int assumpSolveLimited(int64 conflicts, int64 propagations) {
+         _solver->budgetOff();
+         if (conflicts) _solver->setConfBudget(conflicts);
+         if (propagations) _solver->setPropBudget(propagations);
+         startCall();
+         lbool r = _solver->solveLimited(_assump);
+         endCall();
+         _solver->budgetOff();
+         return (r == l_True)? 1: ((r == l_False)? 0: -1);
+      }
+
+      // After an UNSAT assumpSolve(): the Vars of the assumptions the proof
+      // needed, a subset of those given (none: UNSAT without them)
+      void getConflict(vector<Var>& vars) const {
+         vars.clear();
+         for (int i = 0; i < _solver->conflict.size(); ++i)
+            vars.push_back(var(_solver->conflict[i]));
+      }
 
       // For one time proof, use "solve"
       void assertProperty(Var prop, bool val) {
          _solver->addUnit(val? Lit(prop): ~Lit(prop));
       }
-      bool solve() { _solver->solve(); return _solver->okay(); }
+      bool solve() {
+         startCall();
+         _solver->solve();
+         endCall();
+         return _solver->okay();
+      }
 
       // Functions about Reporting
       // Return 1/0/-1; -1 means unknown value
       int getValue(Var v) const {
          return (_solver->modelValue(v)==l_True?1:
                 (_solver->modelValue(v)==l_False?0:-1)); }
-      void printStats() const { const_cast<Solver*>(_solver)->printStats(); }
+      void printStats() const { _solver->printStats(); }
+      // Of the solve calls since initialize(), and of the last one
+      const SatStats& getStats() const { return _stats; }
+      const SatStats& getLastCall() const { return _lastCall; }
 
    private : 
-      Solver           *_solver;    // Pointer to a Minisat solver
+      SimpSolver       *_solver;    // Pointer to a Minisat solver
       Var               _curVar;    // Variable currently
       vec<Lit>          _assump;    // Assumption List for assumption solve
+      SatStats          _stats;     // Totals
+      SatStats          _lastCall;
+      SolverStats       _before;    // _solver->stats when the call started
+      double            _startTime;
+
+      void startCall() {
+         _before = _solver->stats;
+         _startTime = wallTime();
+      }
+      void endCall() {
+         const SolverStats& s = _solver->stats;
+         _lastCall._calls = 1;
+         _lastCall._conflicts = s.conflicts - _before.conflicts;
+         _lastCall._decisions = s.decisions - _before.decisions;
+         _lastCall._propagations = s.propagations - _before.propagations;
+         int64 starts = s.starts - _before.starts;
+         _lastCall._restarts = starts? starts - 1 : 0;
+         _lastCall._learntLits = s.tot_literals - _before.tot_literals;
+         _lastCall._time = wallTime() - _startTime;
+         _lastCall._peakMem = memPeak() / 1048576.0;
+         _stats.add(_lastCall);
+      }
 };
 
 #endif  // SAT_H
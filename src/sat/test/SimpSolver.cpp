@@ -0,0 +1 @@
+../SimpSolver.cpp
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "Solver.h"
+
+using namespace std;
+
+// Differential check of incremental solving: the solver keeps the levels of
+// the assumptions an answer was found under, and the next call only
+// backtracks to the longest prefix it shares with them. Every answer is
+// compared against a fresh solver on the same clauses, e.g.
+//    incTest         (seeds 1..250, about 58k calls)
+//    incTest 1000    (seeds 1..1000)
+//
+// Literals are coded DIMACS style: +(v+1) / -(v+1)
+typedef vector<int> Cls;
+
+static Lit dimacsLit(int l) { return Lit(abs(l) - 1, l < 0); }
+
+static Cls
+randomClause(int nVars, int size)
+{
+   Cls c;
+   for (int j = 0; j < size; ++j) {
+      int v = rand() % nVars + 1;
+      c.push_back(rand() % 2? -v : v);
+   }
+   return c;
+}
+
+static void
+addCls(Solver& s, const Cls& c)
+{
+   vec<Lit> ps;
+   for (size_t j = 0; j < c.size(); ++j) ps.push(dimacsLit(c[j]));
+   s.addClause(ps);
+}
+
+// A fresh solver answers "cls" under "as"
+static bool
+freshSolve(int nVars, const vector<Cls>& cls, const vec<Lit>& as)
+{
+   Solver s;
+   for (int i = 0; i < nVars; ++i) s.newVar();
+   for (size_t i = 0; i < cls.size(); ++i) addCls(s, cls[i]);
+   if (!s.okay()) return false;
+   s.simplifyDB();
+   return s.okay() && s.solve(as);
+}
+
+static bool
+isTrue(const Solver& s, int l)
+{
+   lbool v = s.model[abs(l) - 1];
+   return (l > 0)? v == l_True : v == l_False;
+}
+
+// One random instance: a batch of 3-clauses, then 240 calls with
+// assumptions that share a random prefix with the last call's, and a
+// clause added now and then in between. Return the number of failures.
+static int
+runSeed(int seed, size_t& nCalls)
+{
+   srand(seed);
+   int nVars = 40 + rand() % 30;
+   int nInit = (int)(nVars * (3.2 + (rand() % 60) / 100.0));
+   Solver s;
+   for (int i = 0; i < nVars; ++i) s.newVar();
+   vector<Cls> cls;
+   for (int i = 0; i < nInit; ++i) {
+      cls.push_back(randomClause(nVars, 3));
+      addCls(s, cls.back());
+   }
+
+   int bad = 0;
+   Cls prev;
+   for (int round = 0; round < 240 && s.okay(); ++round) {
+      if (rand() % 12 == 0) {
+         cls.push_back(randomClause(nVars, 3 + rand() % 2));
+         addCls(s, cls.back());
+         if (!s.okay()) break;
+      }
+      Cls a(prev.begin(), prev.begin() + rand() % (prev.size() + 1));
+      for (int k = rand() % 4; k > 0; --k) {
+         int v = rand() % nVars + 1;
+         bool dup = false;
+         for (size_t j = 0; j < a.size(); ++j)
+            if (abs(a[j]) == v) dup = true;
+         if (!dup) a.push_back(rand() % 2? -v : v);
+      }
+      prev = a;
+      vec<Lit> as;
+      for (size_t j = 0; j < a.size(); ++j) as.push(dimacsLit(a[j]));
+
+      bool result = s.solve(as);
+      ++nCalls;
+      if (result != freshSolve(nVars, cls, as)) {
+         cerr << "seed " << seed << " round " << round
+              << ": answer differs from a fresh solver" << endl;
+         ++bad;
+         continue;
+      }
+      if (result) {
+         for (size_t i = 0; i < cls.size(); ++i) {
+            bool sat = false;
+            for (size_t j = 0; j < cls[i].size(); ++j)
+               if (isTrue(s, cls[i][j])) sat = true;
+            if (!sat) {
+               cerr << "seed " << seed << " round " << round
+                    << ": model violates a clause" << endl;
+               ++bad;
+               break;
+            }
+         }
+         for (size_t j = 0; j < a.size(); ++j)
+            if (!isTrue(s, a[j])) {
+               cerr << "seed " << seed << " round " << round
+                    << ": model violates an assumption" << endl;
+               ++bad;
+               break;
+            }
+      }
+      else if (s.okay()) {
+         // the conflict is a subset of the assumptions, UNSAT by itself
+         vec<Lit> sub;
+         for (int i = 0; i < s.conflict.size(); ++i) {
+            Lit l = ~s.conflict[i];
+            bool in = false;
+            for (int j = 0; j < as.size(); ++j)
+               if (as[j] == l) in = true;
+            if (!in) {
+               cerr << "seed " << seed << " round " << round
+                    << ": conflict is not among the assumptions" << endl;
+               ++bad;
+            }
+            sub.push(l);
+         }
+         if (freshSolve(nVars, cls, sub)) {
+            cerr << "seed " << seed << " round " << round
+                 << ": conflict is satisfiable" << endl;
+            ++bad;
+         }
+      }
+   }
+   return bad;
+}
+
+int main(int argc, char** argv)
+{
+   int nSeeds = (argc > 1)? atoi(argv[1]) : 250;
+   size_t nCalls = 0;
+   int bad = 0;
+   for (int seed = 1; seed <= nSeeds; ++seed)
+      bad += runSeed(seed, nCalls);
+   cout << nSeeds << " seeds, " << nCalls << " calls, "
+        << bad << " failures" << endl;
+   return bad != 0;
+}
@@ -0,0 +1,69 @@
+/****************************************************************************
+  FileName     [ myLog.h ]
+  PackageName  [ util ]
+  Synopsis     [ Verbosity level and sink of the messages of the passes ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_LOG_H
+#define MY_LOG_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+// LOG_QUIET  : no messages
+// LOG_SUMMARY: one line of counts per pass (default)
+// LOG_VERBOSE: also one line per gate, as the reference program prints
+enum LogLevel
+{
+   LOG_QUIET,
+   LOG_SUMMARY,
+   LOG_VERBOSE
+};
+
+class MyLog
+{
+public:
+   MyLog(): _level(LOG_SUMMARY), _sink(&cout), _null(0) {}
+   ~MyLog() { closeFile(); }
+
+   LogLevel level() const { return _level; }
+   void setLevel(LogLevel l) { _level = l; }
+   bool summary() const { return _level >= LOG_SUMMARY; }
+   bool verbose() const { return _level >= LOG_VERBOSE; }
+
+   // The sink: stdout (default), a file written through a large buffer,
+   // or nowhere
+   ostream& out() { return *_sink; }
+   const string& sinkName() const { return _sinkName; }
+   void toStdout() { closeFile(); _sink = &cout; _sinkName = ""; }
+   void toNowhere() { closeFile(); _sink = &_null; _sinkName = "(none)"; }
+   bool toFile(const string& name) {
+      closeFile();
+      _file.rdbuf()->pubsetbuf(_buf, sizeof(_buf));  // before open()
+      _file.open(name.c_str(), ios::out | ios::trunc);
+      if (!_file) { toStdout(); return false; }
+      _sink = &_file;
+      _sinkName = name;
+      return true;
+   }
+
+private:
+   void closeFile() {
+      if (_file.is_open()) _file.close();
+      _file.clear();
+   }
+
+   LogLevel   _level;
+   ostream*   _sink;
+   ofstream   _file;
+   ostream    _null;       // no stream buffer: every write fails at once
+   string     _sinkName;   // "": stdout
+   char       _buf[1 << 16];
+};
+
+#endif // MY_LOG_H
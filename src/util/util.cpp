@@ -5,8 +5,10 @@
   Author       [ Chung-Yang (Ric) Huang ]
   Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
 ****************************************************************************/
+#include <sys/time.h>
 #include "rnGen.h"
 #include "myUsage.h"
+#include "myLog.h"
 
 //----------------------------------------------------------------------
 //    Global variables in util
@@ -14,6 +16,7 @@
 
 RandomNumGen  rnGen(0);  // use random seed = 0
 MyUsage       myUsage;
+MyLog         myLog;
 
 size_t getHashSize(size_t s) {
    if (s < 8) return 7;
@@ -35,3 +38,10 @@ size_t getHashSize(size_t s) {
    return 7000003;
 }
 
+
+// Seconds since the epoch; for wall-clock budgets, not for profiling
+double getWallTime() {
+   timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
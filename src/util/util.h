@@ -11,12 +11,14 @@
 #include <istream>
 #include "rnGen.h"
 #include "myUsage.h"
+#include "myLog.h"
 
 using namespace std;
 
 // Extern global variable defined in util.cpp
 extern RandomNumGen  rnGen;
 extern MyUsage       myUsage;
+extern MyLog         myLog;
 
 // In myString.cpp
 extern int myStrNCmp(const string& s1, const string& s2, unsigned n);
@@ -31,6 +33,7 @@ extern char myGetChar();
 
 // In util.cpp
 extern size_t getHashSize(size_t s);
+extern double getWallTime();
 
 // Other utility template functions
 template<class T>